@@ -6,7 +6,8 @@
 
 Elevator::Elevator(int id, int floorTravelTime)
     : id(id), currentFloor(1), state(ElevatorState::STOPPED),
-      floorTimer(0), stopTimer(0), floorTravelTime(floorTravelTime), targetFloor(1)
+      floorTimer(0), stopTimer(0), floorTravelTime(floorTravelTime), targetFloor(1),
+      delivered(0)
 {}
 
 void Elevator::update(int currentTime, std::vector<Floor>& floors) {
@@ -114,6 +115,7 @@ void Elevator::dischargePassengers(int currentTime) {
                      << " at floor " << currentFloor << " at t=" << currentTime
                      << " (wait=" << p->waitTime() << "s, travel=" << p->travelTime() << "s)";
             it = onBoard.erase(it);
+            ++delivered;
         } else {
             ++it;
         }
@@ -147,3 +149,55 @@ int Elevator::determineTargetFloor(const std::vector<Floor>& floors) const {
     }
     return nearest;
 }
+
+void Elevator::skip(int ticks) {
+    // Same effect as `ticks` calls to update() that reach no floor where the
+    // elevator could stop; the event engine guarantees that.
+    if (ticks <= 0) return;
+    switch (state) {
+    case ElevatorState::MOVING_UP:
+    case ElevatorState::MOVING_DOWN: {
+        int step = state == ElevatorState::MOVING_UP ? 1 : -1;
+        floorTimer -= ticks;
+        while (floorTimer <= 0) {
+            currentFloor += step;
+            floorTimer   += floorTravelTime;
+        }
+        break;
+    }
+    case ElevatorState::STOPPING:
+        stopTimer -= ticks;
+        if (stopTimer <= 0) {
+            stopTimer = 0;
+            state     = ElevatorState::STOPPED;
+        }
+        break;
+    case ElevatorState::STOPPED:
+        break;
+    }
+}
+
+int Elevator::nextStopCandidate(const std::vector<Floor>& floors) const {
+    // First floor ahead where update() would stop if the floors stayed as they
+    // are now. Only a passenger arriving further along can move the stop closer.
+    int step  = state == ElevatorState::MOVING_UP ? 1 : -1;
+    int limit = step > 0 ? static_cast<int>(floors.size()) : 1;
+    if ((targetFloor - currentFloor) * step > 0 && (limit - targetFloor) * step > 0) {
+        limit = targetFloor;
+    }
+    for (const Passenger* p : onBoard) {
+        if ((p->endFloor - currentFloor) * step > 0 && (limit - p->endFloor) * step > 0) {
+            limit = p->endFloor;
+        }
+    }
+    for (int f = currentFloor + step; f != limit; f += step) {
+        if (floors[f - 1].hasWaiting()) return f;
+    }
+    return limit;
+}
+
+int Elevator::timeToReach(int floor, int currentTime) const {
+    // Tick at which a moving elevator, last updated at `currentTime`, arrives
+    // at `floor` ahead of it.
+    return currentTime + floorTimer + (std::abs(floor - currentFloor) - 1) * floorTravelTime;
+}
@@ -15,6 +15,7 @@ public:
     int                     stopTimer;
     int                     floorTravelTime;
     int                     targetFloor;
+    int                     delivered;   // passengers discharged so far
 
     Elevator(int id, int floorTravelTime);
 
@@ -24,6 +25,11 @@ public:
     void dischargePassengers(int currentTime);
     bool hasWork(const std::vector<Floor>& floors) const;
 
+    // Discrete-event support
+    void skip(int ticks);
+    int  nextStopCandidate(const std::vector<Floor>& floors) const;
+    int  timeToReach(int floor, int currentTime) const;
+
 private:
     int determineTargetFloor(const std::vector<Floor>& floors) const;
 };
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <queue>
+#include <vector>
+
+// Things that can change the simulation between two ticks. Everything else an
+// elevator does (counting down between floors, dwelling while STOPPING) is a
+// pure function of time and is replayed by Elevator::skip().
+enum class EventType {
+    PASSENGER_ARRIVAL,  // passenger appears on their start floor
+    FLOOR_REACHED,      // moving elevator arrives at a floor where it may stop
+    DOORS_CLOSED        // stopped elevator unloads, loads and picks a direction
+};
+
+struct Event {
+    int       time;
+    EventType type;
+    int       subject;  // passenger index or elevator id
+    int       version;  // elevator events: stale unless it matches the elevator's
+};
+
+// Min-heap order matching one tick of Simulation::run(): by time, then all
+// arrivals (in passenger order) before any elevator, then elevators by id.
+struct EventAfter {
+    bool operator()(const Event& a, const Event& b) const {
+        if (a.time != b.time) return a.time > b.time;
+        bool aArrival = a.type == EventType::PASSENGER_ARRIVAL;
+        bool bArrival = b.type == EventType::PASSENGER_ARRIVAL;
+        if (aArrival != bArrival) return bArrival;
+        return a.subject > b.subject;
+    }
+};
+
+using EventQueue = std::priority_queue<Event, std::vector<Event>, EventAfter>;
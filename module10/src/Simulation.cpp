@@ -1,12 +1,15 @@
 #include "Simulation.h"
+#include "Event.h"
 #include "Logger.h"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <iomanip>
 
 Simulation::Simulation(int floorTravelTime)
-    : building(floorTravelTime), currentTime(0), floorTravelTime(floorTravelTime)
+    : building(floorTravelTime), currentTime(0), floorTravelTime(floorTravelTime),
+      eventsProcessed(0)
 {}
 
 void Simulation::loadCSV(const std::string& filename) {
@@ -36,10 +39,13 @@ void Simulation::loadCSV(const std::string& filename) {
 
 void Simulation::run() {
     currentTime = 0;
+    std::vector<int> order = arrivalOrder();
+    size_t next = 0;
 
     while (!allPassengersArrived()) {
         // Spawn passengers whose start time has arrived
-        for (Passenger& p : passengers) {
+        while (next < order.size() && passengers[order[next]].startTime <= currentTime) {
+            Passenger& p = passengers[order[next++]];
             if (p.startTime == currentTime && p.state == PassengerState::WAITING) {
                 building.spawnPassenger(&p);
                 LOG_INFO << "Passenger " << p.id << " arrives at floor "
@@ -67,6 +73,121 @@ void Simulation::run() {
               << " passengers arrived at t=" << currentTime << "\n";
 }
 
+void Simulation::runEvents() {
+    // Same model as run(), but time jumps from one event to the next instead
+    // of ticking. Elevators are only updated on the ticks where run() would
+    // see them do something that depends on the floors; Elevator::skip()
+    // replays the countdowns in between. Idle elevators sleep until the next
+    // passenger arrival, and a moving elevator sleeps until the next floor it
+    // could stop at, rescheduled earlier if someone turns up on its way.
+    std::vector<Elevator>& elevators = building.elevators;
+    std::vector<Floor>&    floors    = building.floors;
+    std::vector<int>  lastUpdate(elevators.size(), -1);
+    std::vector<int>  version(elevators.size(), 0);
+    std::vector<int>  plannedFloor(elevators.size(), 0);
+    std::vector<bool> idle(elevators.size(), false);
+    EventQueue events;
+
+    currentTime     = 0;
+    eventsProcessed = 0;
+    // Only the next arrival is queued; each arrival queues its successor, so
+    // the heap holds a handful of events however many passengers there are.
+    std::vector<int> order = arrivalOrder();
+    size_t next = 0;
+    while (next < order.size() && passengers[order[next]].startTime < 0) ++next;
+    auto queueNextArrival = [&] {
+        if (next < order.size()) {
+            int i = order[next++];
+            events.push({passengers[i].startTime, EventType::PASSENGER_ARRIVAL, i, 0});
+        }
+    };
+    queueNextArrival();
+    // run() updates every elevator from t=0
+    for (const Elevator& e : elevators) {
+        events.push({0, EventType::DOORS_CLOSED, e.id, 0});
+    }
+
+    // Queues the next event of elevator `id`, just updated at `time`.
+    auto schedule = [&](int id, int time) {
+        Elevator& e = elevators[id];
+        ++version[id];
+        switch (e.state) {
+        case ElevatorState::MOVING_UP:
+        case ElevatorState::MOVING_DOWN: {
+            plannedFloor[id] = e.nextStopCandidate(floors);
+            events.push({e.timeToReach(plannedFloor[id], time), EventType::FLOOR_REACHED,
+                         id, version[id]});
+            break;
+        }
+        case ElevatorState::STOPPING:
+            // STOPPED once the dwell runs out, serving the floor a tick later
+            events.push({time + e.stopTimer + 1, EventType::DOORS_CLOSED, id, version[id]});
+            break;
+        case ElevatorState::STOPPED:
+            if (e.hasWork(floors)) {
+                events.push({time + 1, EventType::DOORS_CLOSED, id, version[id]});
+            } else {
+                idle[id] = true;
+            }
+            break;
+        }
+    };
+
+    while (!allPassengersArrived() && !events.empty()) {
+        Event ev = events.top();
+        events.pop();
+        currentTime = ev.time;
+
+        if (ev.type == EventType::PASSENGER_ARRIVAL) {
+            Passenger& p = passengers[ev.subject];
+            building.spawnPassenger(&p);
+            LOG_INFO << "Passenger " << p.id << " arrives at floor "
+                     << p.startFloor << " at t=" << currentTime;
+            ++eventsProcessed;
+            queueNextArrival();
+
+            for (Elevator& e : elevators) {
+                int id = e.id;
+                if (idle[id]) {
+                    idle[id] = false;
+                    ++version[id];
+                    events.push({currentTime, EventType::DOORS_CLOSED, id, version[id]});
+                } else if (e.state == ElevatorState::MOVING_UP ||
+                           e.state == ElevatorState::MOVING_DOWN) {
+                    // Pull the next stop in if the new passenger is on the way
+                    int step = e.state == ElevatorState::MOVING_UP ? 1 : -1;
+                    int f    = p.startFloor;
+                    if ((f - e.currentFloor) * step > 0 && (plannedFloor[id] - f) * step > 0) {
+                        int reach = e.timeToReach(f, lastUpdate[id]);
+                        if (reach >= currentTime) {
+                            plannedFloor[id] = f;
+                            ++version[id];
+                            events.push({reach, EventType::FLOOR_REACHED, id, version[id]});
+                        }
+                    }
+                }
+            }
+            continue;
+        }
+
+        if (ev.version != version[ev.subject]) continue;  // superseded
+        Elevator& e = elevators[ev.subject];
+        e.skip(currentTime - lastUpdate[ev.subject] - 1);
+        e.update(currentTime, floors);
+        lastUpdate[ev.subject] = currentTime;
+        schedule(ev.subject, currentTime);
+        ++eventsProcessed;
+    }
+    ++currentTime;  // run() stops after the tick that delivered the last passenger
+    if (passengers.empty()) currentTime = 0;
+
+    LOG_INFO << "All " << passengers.size()
+             << " passengers arrived at t=" << currentTime
+             << " (" << eventsProcessed << " events)";
+    std::cout << "[INFO] All " << passengers.size()
+              << " passengers arrived at t=" << currentTime << "\n";
+}
+
 void Simulation::reportStatistics() const {
     double totalWait = 0.0, totalTravel = 0.0;
     for (const Passenger& p : passengers) {
@@ -95,8 +216,24 @@ void Simulation::reset(int newFloorTime) {
 }
 
 bool Simulation::allPassengersArrived() const {
-    for (const Passenger& p : passengers) {
-        if (p.state != PassengerState::ARRIVED) return false;
+    // Every arrival goes through an elevator's discharge, so the counters
+    // answer this without walking all passengers each tick.
+    size_t delivered = 0;
+    for (const Elevator& e : building.elevators) {
+        delivered += e.delivered;
+    }
+    return delivered == passengers.size();
+}
+
+std::vector<int> Simulation::arrivalOrder() const {
+    // Passenger indices by start time; ties keep file order, which is the
+    // order run() spawns them in within one tick.
+    std::vector<int> order(passengers.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<int>(i);
     }
-    return true;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return passengers[a].startTime < passengers[b].startTime;
+    });
+    return order;
 }
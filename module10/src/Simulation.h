@@ -11,14 +11,17 @@ public:
     std::vector<Passenger> passengers;
     int                   currentTime;
     int                   floorTravelTime;
+    long long             eventsProcessed;   // by the last runEvents()
 
     explicit Simulation(int floorTravelTime);
 
     void loadCSV(const std::string& filename);
     void run();
+    void runEvents();
     void reportStatistics() const;
     void reset(int newFloorTime);
 
 private:
-    bool allPassengersArrived() const;
+    bool             allPassengersArrived() const;
+    std::vector<int> arrivalOrder() const;
 };
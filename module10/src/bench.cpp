@@ -0,0 +1,91 @@
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/log/core.hpp>
+#include "Simulation.h"
+
+// Tick engine vs discrete-event engine: checks that both give every passenger
+// the same board and exit times on Elevator.csv, then times them on a large
+// generated workload.
+//
+// Usage: elevator_bench [passengers] [mean seconds between arrivals] [seed]
+
+struct Outcome {
+    int                 endTime;
+    std::vector<int>    boardTimes;
+    std::vector<int>    exitTimes;
+    long long           steps;    // ticks or events
+    double              seconds;
+};
+
+static Outcome runEngine(Simulation& sim, int floorTime, bool events) {
+    sim.reset(floorTime);
+    auto start = std::chrono::steady_clock::now();
+    events ? sim.runEvents() : sim.run();
+    auto end   = std::chrono::steady_clock::now();
+
+    Outcome out;
+    out.endTime = sim.currentTime;
+    for (const Passenger& p : sim.passengers) {
+        out.boardTimes.push_back(p.boardTime);
+        out.exitTimes.push_back(p.exitTime);
+    }
+    out.steps   = events ? sim.eventsProcessed : sim.currentTime;
+    out.seconds = std::chrono::duration<double>(end - start).count();
+    return out;
+}
+
+static bool sameResults(const Outcome& a, const Outcome& b) {
+    return a.endTime == b.endTime && a.boardTimes == b.boardTimes && a.exitTimes == b.exitTimes;
+}
+
+static void compare(Simulation& sim, int floorTime, const std::string& label) {
+    Outcome ticks  = runEngine(sim, floorTime, false);
+    Outcome events = runEngine(sim, floorTime, true);
+
+    std::cout << std::fixed << std::setprecision(3)
+              << label << ", " << floorTime << " s/floor: "
+              << (sameResults(ticks, events) ? "identical" : "MISMATCH")
+              << " (end t=" << ticks.endTime << " / " << events.endTime << ")\n"
+              << "  ticks : " << std::setw(10) << ticks.steps  << " steps "
+              << std::setw(9) << ticks.seconds  << " s\n"
+              << "  events: " << std::setw(10) << events.steps << " steps "
+              << std::setw(9) << events.seconds << " s"
+              << "  speedup " << std::setprecision(1) << ticks.seconds / events.seconds << "x\n";
+}
+
+int main(int argc, char* argv[]) {
+    int      count   = argc > 1 ? std::stoi(argv[1]) : 100000;
+    double   meanGap = argc > 2 ? std::stod(argv[2]) : 30.0;
+    unsigned seed    = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 42u;
+
+    // Per-passenger logging would dominate both engines
+    boost::log::core::get()->set_logging_enabled(false);
+
+    Simulation csv(10);
+    csv.loadCSV("Elevator.csv");
+    if (!csv.passengers.empty()) {
+        compare(csv, 10, "Elevator.csv");
+        compare(csv, 5,  "Elevator.csv");
+    }
+
+    // Poisson arrivals, uniform distinct start and end floors
+    std::mt19937 rng(seed);
+    std::exponential_distribution<double> gap(1.0 / meanGap);
+    std::uniform_int_distribution<int>    floor(1, 100);
+    Simulation generated(10);
+    double t = 0.0;
+    for (int i = 0; i < count; ++i) {
+        int from = floor(rng), to = floor(rng);
+        while (to == from) to = floor(rng);
+        generated.passengers.emplace_back(i, static_cast<int>(t), from, to);
+        t += gap(rng);
+    }
+    std::string label = std::to_string(count) + " passengers";
+    compare(generated, 10, label);
+    compare(generated, 5,  label);
+    return 0;
+}
@@ -1,9 +1,13 @@
 #include <iostream>
 #include <iomanip>
+#include <string>
 #include "Logger.h"
 #include "Simulation.h"
 
-int main() {
+int main(int argc, char* argv[]) {
+    // --events: run the discrete-event engine instead of ticking every second
+    bool events = argc > 1 && std::string(argv[1]) == "--events";
+
     Logger::init("simulation.log");
 
     // ── Run 1: 10 s/floor ──────────────────────────────────────────────────
@@ -12,7 +16,7 @@ int main() {
 
     Simulation sim(10);
     sim.loadCSV("Elevator.csv");
-    sim.run();
+    events ? sim.runEvents() : sim.run();
     sim.reportStatistics();
 
     // Save run-1 averages for comparison
@@ -30,7 +34,7 @@ int main() {
     LOG_INFO  << "=== Simulation Run 2: 5 seconds/floor ===";
 
     sim.reset(5);
-    sim.run();
+    events ? sim.runEvents() : sim.run();
 
     double totalWait2 = 0.0, totalTravel2 = 0.0;
     for (const Passenger& p : sim.passengers) {
@@ -0,0 +1,190 @@
+#include "backend.h"
+
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef MODULE14_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#ifdef MODULE14_HAVE_PARALLEL_STL
+#include <algorithm>
+#include <execution>
+#if __has_include(<tbb/global_control.h>)
+#include <tbb/global_control.h>
+#define MODULE14_HAVE_TBB_CONTROL 1
+#endif
+#endif
+
+namespace
+{
+
+// Range [first, last) of slot `slot` when [begin, end) is split into `slots`
+// near-equal parts, the split ThreadPool::parallelFor uses.
+void rangeOf(int begin, int end, int slot, int slots, int &first, int &last)
+{
+    const long long count = end - begin;
+    first = begin + static_cast<int>(count * slot / slots);
+    last = begin + static_cast<int>(count * (slot + 1) / slots);
+}
+
+class PoolBackend : public Backend
+{
+public:
+    PoolBackend(int workers, WakePolicy wake) : pool_(workers, wake) {}
+
+    BackendKind kind() const override { return BackendKind::Pool; }
+    int workers() const override { return pool_.size(); }
+    void parallelFor(int begin, int end, const RangeTask &task) override { pool_.parallelFor(begin, end, task); }
+    ThreadPool *threadPool() override { return &pool_; }
+
+private:
+    ThreadPool pool_;
+};
+
+// Starts workers - 1 threads for every call; the caller runs slot 0.
+class ThreadBackend : public Backend
+{
+public:
+    explicit ThreadBackend(int workers) : workers_(workers) {}
+
+    BackendKind kind() const override { return BackendKind::Threads; }
+    int workers() const override { return workers_; }
+
+    void parallelFor(int begin, int end, const RangeTask &task) override
+    {
+        auto runSlot = [&](int slot)
+        {
+            int first, last;
+            rangeOf(begin, end, slot, workers_, first, last);
+            if (first < last)
+                task(slot, first, last);
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(workers_ - 1);
+        for (int slot = 1; slot < workers_; slot++)
+            threads.emplace_back(runSlot, slot);
+        runSlot(0);
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+private:
+    int workers_;
+};
+
+#ifdef MODULE14_HAVE_OPENMP
+class OpenMPBackend : public Backend
+{
+public:
+    explicit OpenMPBackend(int workers) : workers_(workers) {}
+
+    BackendKind kind() const override { return BackendKind::OpenMP; }
+    int workers() const override { return workers_; }
+
+    void parallelFor(int begin, int end, const RangeTask &task) override
+    {
+        const int slots = workers_;
+#pragma omp parallel for schedule(static, 1) num_threads(slots)
+        for (int slot = 0; slot < slots; slot++)
+        {
+            int first, last;
+            rangeOf(begin, end, slot, slots, first, last);
+            if (first < last)
+                task(slot, first, last);
+        }
+    }
+
+private:
+    int workers_;
+};
+#endif
+
+#ifdef MODULE14_HAVE_PARALLEL_STL
+// The standard library picks its own threads; with TBB underneath, a
+// global_control caps them at `workers` while the backend exists.
+class ParallelStlBackend : public Backend
+{
+public:
+    explicit ParallelStlBackend(int workers) : slots_(workers)
+#ifdef MODULE14_HAVE_TBB_CONTROL
+        , control_(tbb::global_control::max_allowed_parallelism, static_cast<std::size_t>(workers))
+#endif
+    {
+        std::iota(slots_.begin(), slots_.end(), 0);
+    }
+
+    BackendKind kind() const override { return BackendKind::ParallelStl; }
+    int workers() const override { return static_cast<int>(slots_.size()); }
+
+    void parallelFor(int begin, int end, const RangeTask &task) override
+    {
+        const int slots = workers();
+        std::for_each(std::execution::par_unseq, slots_.begin(), slots_.end(), [&](int slot)
+                      {
+                          int first, last;
+                          rangeOf(begin, end, slot, slots, first, last);
+                          if (first < last)
+                              task(slot, first, last);
+                      });
+    }
+
+private:
+    std::vector<int> slots_;
+#ifdef MODULE14_HAVE_TBB_CONTROL
+    tbb::global_control control_;
+#endif
+};
+#endif
+
+} // namespace
+
+bool backendAvailable(BackendKind kind)
+{
+    switch (kind)
+    {
+    case BackendKind::Pool:
+    case BackendKind::Threads:
+        return true;
+    case BackendKind::OpenMP:
+#ifdef MODULE14_HAVE_OPENMP
+        return true;
+#else
+        return false;
+#endif
+    case BackendKind::ParallelStl:
+#ifdef MODULE14_HAVE_PARALLEL_STL
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+std::unique_ptr<Backend> makeBackend(BackendKind kind, int workers, WakePolicy wake)
+{
+    workers = workers > 0 ? workers : 1;
+    switch (kind)
+    {
+    case BackendKind::Pool:
+        return std::make_unique<PoolBackend>(workers, wake);
+    case BackendKind::Threads:
+        return std::make_unique<ThreadBackend>(workers);
+    case BackendKind::OpenMP:
+#ifdef MODULE14_HAVE_OPENMP
+        return std::make_unique<OpenMPBackend>(workers);
+#else
+        break;
+#endif
+    case BackendKind::ParallelStl:
+#ifdef MODULE14_HAVE_PARALLEL_STL
+        return std::make_unique<ParallelStlBackend>(workers);
+#else
+        break;
+#endif
+    }
+    throw std::invalid_argument(std::string("Backend ") + backendName(kind) + " is not available in this build");
+}
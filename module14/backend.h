@@ -0,0 +1,77 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "thread_pool.h"
+
+// Parallel runtimes the module14 kernels can run on.
+//   Pool        - the persistent ThreadPool (threads created once, reused).
+//   Threads     - raw std::thread: workers - 1 threads started and joined per call.
+//   OpenMP      - `#pragma omp parallel for` over the ranges (built with OpenMP).
+//   ParallelStl - std::for_each(std::execution::par_unseq, ...) over the ranges
+//                 (built with a parallel standard library, TBB for libstdc++).
+enum class BackendKind
+{
+    Pool,
+    Threads,
+    OpenMP,
+    ParallelStl
+};
+
+constexpr BackendKind ALL_BACKENDS[] = {BackendKind::Pool, BackendKind::Threads, BackendKind::OpenMP,
+                                        BackendKind::ParallelStl};
+
+inline const char *backendName(BackendKind kind)
+{
+    switch (kind)
+    {
+    case BackendKind::Pool:        return "pool";
+    case BackendKind::Threads:     return "thread";
+    case BackendKind::OpenMP:      return "openmp";
+    case BackendKind::ParallelStl: return "par_unseq";
+    }
+    return "unknown";
+}
+
+inline bool parseBackend(const std::string &text, BackendKind &kind)
+{
+    for (BackendKind candidate : ALL_BACKENDS)
+        if (text == backendName(candidate))
+        {
+            kind = candidate;
+            return true;
+        }
+    return false;
+}
+
+// True when this build includes `kind` (OpenMP and the parallel STL are
+// detected by CMake).
+bool backendAvailable(BackendKind kind);
+
+// The one operation kernels need from a runtime. parallelFor splits
+// [begin, end) into workers() contiguous near-equal ranges, like
+// ThreadPool::parallelFor, and calls task(slot, first, last) once per non-empty
+// range, possibly concurrently, returning when all are done. `slot` is unique
+// per range, so per-slot partial sums need no locking. Under par_unseq it is not
+// a thread id, and tasks must not block on each other.
+class Backend
+{
+public:
+    using RangeTask = ThreadPool::RangeTask;
+
+    virtual ~Backend() = default;
+
+    virtual BackendKind kind() const = 0;
+    virtual int workers() const = 0;
+    virtual void parallelFor(int begin, int end, const RangeTask &task) = 0;
+    // The persistent pool behind this backend, for pinning; null when the
+    // runtime owns its threads.
+    virtual ThreadPool *threadPool() { return nullptr; }
+
+    const char *name() const { return backendName(kind()); }
+};
+
+// Backend of `kind` with `workers` ranges per call (and threads, where the
+// runtime lets us choose). Throws std::invalid_argument when `kind` is not
+// available in this build.
+std::unique_ptr<Backend> makeBackend(BackendKind kind, int workers, WakePolicy wake = WakePolicy::Park);
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "matrix.h"
+#include "pages.h"
+#include "rng.h"
+#include "scheduler.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+// Below this many elements per operand a batched add runs on the calling
+// thread: waking the pool costs more than the work.
+constexpr std::size_t BATCH_SERIAL_ELEMENTS = 32 * 1024;
+
+// `count` row-major rows x cols matrices stored back to back in one strided
+// tensor. Rows inside a matrix are packed (row stride = cols). A matrix of at
+// least a cache line is padded to whole cache lines and the padding is kept at
+// zero; smaller ones are packed densely. Either way the tensor is also one flat
+// array whose element sum equals the sum of its matrices, so a run of whole
+// matrices is added by a single kernel call that vectorizes across the batch
+// dimension, whatever the matrix shape.
+template <typename T>
+class MatrixBatch
+{
+public:
+    MatrixBatch() = default;
+
+    MatrixBatch(std::size_t count, std::size_t rows, std::size_t cols, PagePolicy pages = PagePolicy::Heap)
+        : rows_(rows), cols_(cols), storage_(count, rows * cols, batchStride(rows * cols), pages)
+    {
+        const std::size_t used = rows * cols, stride = storage_.stride();
+        if (stride > used)
+            for (std::size_t b = 0; b < count; b++)
+                std::fill(matrix(b) + used, matrix(b) + stride, T(0));
+    }
+
+    T &operator()(std::size_t b, std::size_t row, std::size_t col) { return matrix(b)[row * cols_ + col]; }
+    const T &operator()(std::size_t b, std::size_t row, std::size_t col) const { return matrix(b)[row * cols_ + col]; }
+
+    // First element of matrix b; its rows follow at a stride of cols().
+    T *matrix(std::size_t b) { return storage_.row(b).data(); }
+    const T *matrix(std::size_t b) const { return storage_.row(b).data(); }
+
+    TileView<T> view(std::size_t b) { return TileView<T>(matrix(b), rows_, cols_, cols_); }
+    TileView<const T> view(std::size_t b) const { return TileView<const T>(matrix(b), rows_, cols_, cols_); }
+
+    T *data() { return storage_.data(); }
+    const T *data() const { return storage_.data(); }
+    std::size_t count() const { return storage_.rows(); }
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    // Elements from one matrix to the next (rows * cols plus padding).
+    std::size_t matrixStride() const { return storage_.stride(); }
+    PageBacking backing() const { return storage_.backing(); }
+
+private:
+    static std::size_t batchStride(std::size_t elements)
+    {
+        return elements * sizeof(T) < CACHE_LINE_SIZE ? elements : Matrix<T>::paddedStride(elements);
+    }
+
+    std::size_t rows_ = 0;
+    std::size_t cols_ = 0;
+    Matrix<T> storage_; // one storage row per matrix
+};
+
+template <typename T>
+bool sameShape(const MatrixBatch<T> &a, const MatrixBatch<T> &b)
+{
+    return a.count() == b.count() && a.rows() == b.rows() && a.cols() == b.cols();
+}
+
+// Fills every matrix of `batch` with random matrix `stream`, matrix b being
+// row b of the flattened (count x rows*cols) random matrix. Whole matrices are
+// spread over the pool so each worker first-touches the matrices it will add.
+template <typename T>
+void fillRandom(ThreadPool &pool, MatrixBatch<T> &batch, std::uint32_t stream, std::uint64_t seed = DEFAULT_SEED,
+                std::uint32_t range = valueRange<T>())
+{
+    const Philox4x32 rng(seed);
+    const std::size_t used = batch.rows() * batch.cols();
+    pool.parallelFor(0, static_cast<int>(batch.count()), [&](int, int begin, int end)
+                     {
+                         for (int b = begin; b < end; b++)
+                             randomRow(rng, stream, b, 0, used, batch.matrix(b), range);
+                     });
+}
+
+// Runs body(worker, first, last) over matrix indices [0, count), on the pool
+// when the batch holds at least BATCH_SERIAL_ELEMENTS elements and on the
+// calling thread (as worker 0) otherwise.
+template <typename Body>
+void forBatch(ThreadPool &pool, std::size_t count, std::size_t elements, Body body)
+{
+    if (elements < BATCH_SERIAL_ELEMENTS || pool.size() == 1)
+        body(0, 0, static_cast<int>(count));
+    else
+        pool.parallelFor(0, static_cast<int>(count), body);
+}
+
+// Adds two batches matrix by matrix into `result` and returns the sum of all
+// result elements. Every worker takes a contiguous run of whole matrices and
+// adds it with one kernel call over the flat tensor, so even 4x4 matrices
+// fill the vector lanes and no matrix is split between threads.
+template <typename T>
+AccumulatorOf<T> matrixAddBatch(ThreadPool &pool,
+                                const MatrixBatch<T> &left,
+                                const MatrixBatch<T> &right,
+                                MatrixBatch<T> &result,
+                                AddKernelOf<T> kernel = activeAddKernel<T>())
+{
+    if (!sameShape(left, right) || !sameShape(left, result))
+        throw std::invalid_argument("matrixAddBatch operands differ in shape");
+
+    const std::size_t stride = result.matrixStride();
+    std::vector<Padded<AccumulatorOf<T>>> sums(pool.size());
+    forBatch(pool, result.count(), result.count() * stride, [&](int worker, int first, int last)
+             {
+                 const std::size_t offset = first * stride, length = (last - first) * stride;
+                 sums[worker].value += kernel(left.data() + offset, right.data() + offset,
+                                              result.data() + offset, length);
+             });
+
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &sum : sums)
+        total += sum.value;
+    return total;
+}
+
+// Batched add over separately allocated matrices: result[i] = left[i] +
+// right[i]. Whole matrices are spread across the pool with one dispatch for
+// the batch; each matrix is added row by row since their storage is not
+// contiguous. Prefer MatrixBatch for the smallest shapes.
+template <typename T>
+AccumulatorOf<T> matrixAddBatch(ThreadPool &pool,
+                                const std::vector<Matrix<T>> &left,
+                                const std::vector<Matrix<T>> &right,
+                                std::vector<Matrix<T>> &result,
+                                AddKernelOf<T> kernel = activeAddKernel<T>())
+{
+    if (left.size() != right.size() || left.size() != result.size())
+        throw std::invalid_argument("matrixAddBatch operands differ in length");
+    std::size_t elements = 0;
+    for (std::size_t i = 0; i < result.size(); i++)
+    {
+        const Matrix<T> &l = left[i], &r = right[i], &out = result[i];
+        if (l.rows() != out.rows() || l.cols() != out.cols() || r.rows() != out.rows() || r.cols() != out.cols())
+            throw std::invalid_argument("matrixAddBatch operands differ in shape");
+        elements += out.size();
+    }
+
+    std::vector<Padded<AccumulatorOf<T>>> sums(pool.size());
+    forBatch(pool, result.size(), elements, [&](int worker, int first, int last)
+             {
+                 AccumulatorOf<T> sum = 0;
+                 for (int i = first; i < last; i++)
+                     for (std::size_t row = 0; row < result[i].rows(); row++)
+                         sum += kernel(left[i].row(row).data(), right[i].row(row).data(), result[i].row(row).data(),
+                                       result[i].cols());
+                 sums[worker].value += sum;
+             });
+
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &sum : sums)
+        total += sum.value;
+    return total;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "matrix.h"
+#include "thread_pool.h"
+#include "timing.h"
+
+// One measured configuration. `tags` carries free-form labels (schedule, ISA,
+// pinning policy, ...) that become extra JSON fields and CSV columns.
+struct BenchRecord
+{
+    std::string kernel;
+    int rows = 0;
+    int cols = 0;
+    int threads = 1;
+    TimingStats stats;
+    double bytes = 0; // bytes moved per call
+    std::vector<std::pair<std::string, std::string>> tags;
+};
+
+inline double gigabytesPerSecond(double bytes, double nanos)
+{
+    return nanos > 0 ? bytes / nanos : 0;
+}
+
+// STREAM triad a[i] = b[i] + s * c[i] on three arrays of `elements` doubles,
+// split statically over `pool`. Returns the best bandwidth in GB/s, counting
+// 24 bytes per element as STREAM does (no write-allocate traffic).
+inline double measureStreamTriad(ThreadPool &pool, std::size_t elements, int reps)
+{
+    Matrix<double> a(1, elements), b(1, elements), c(1, elements);
+    const int count = static_cast<int>(elements);
+    pool.parallelFor(0, count, [&](int, int begin, int end)
+                     {
+                         for (int i = begin; i < end; i++)
+                         {
+                             a(0, i) = 0;
+                             b(0, i) = 1;
+                             c(0, i) = 2;
+                         }
+                     });
+
+    const double scalar = 3.0;
+    TimingStats stats = measure(1, reps, [&]
+                                {
+                                    pool.parallelFor(0, count, [&](int, int begin, int end)
+                                                     {
+                                                         double *pa = a.data();
+                                                         const double *pb = b.data();
+                                                         const double *pc = c.data();
+                                                         for (int i = begin; i < end; i++)
+                                                             pa[i] = pb[i] + scalar * pc[i];
+                                                     });
+                                });
+    return gigabytesPerSecond(3.0 * sizeof(double) * elements, stats.minNs);
+}
+
+// "Elapsed time" block of the threaded/unthreaded executables.
+inline void printElapsed(std::ostream &out, const TimingStats &stats, double bytes)
+{
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3) << "Elapsed time: " << stats.medianNs / 1e6 << " ms median over "
+        << stats.samples << " runs (min " << stats.minNs / 1e6 << ", p99 " << stats.p99Ns / 1e6 << ", stddev "
+        << stats.stddevNs / 1e6 << " ms)\n"
+        << std::setprecision(2) << "Bandwidth:    " << gigabytesPerSecond(bytes, stats.medianNs) << " GB/s\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// Prints a fixed-width table row per record; `streamGBs` > 0 adds a column with
+// the median bandwidth as a fraction of STREAM triad bandwidth.
+inline void printRecordHeader(std::ostream &out, bool withStream)
+{
+    out << std::left << std::setw(12) << "kernel" << std::right << std::setw(7) << "rows" << std::setw(7) << "cols"
+        << std::setw(5) << "thr" << std::setw(12) << "min (ns)" << std::setw(12) << "median" << std::setw(12)
+        << "p99" << std::setw(10) << "stddev" << std::setw(9) << "GB/s";
+    if (withStream)
+        out << std::setw(9) << "%STREAM";
+    out << "  tags\n";
+}
+
+inline void printRecord(std::ostream &out, const BenchRecord &record, double streamGBs)
+{
+    const double gbs = gigabytesPerSecond(record.bytes, record.stats.medianNs);
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::left << std::setw(12) << record.kernel << std::right << std::setw(7) << record.rows << std::setw(7)
+        << record.cols << std::setw(5) << record.threads << std::fixed << std::setprecision(0) << std::setw(12)
+        << record.stats.minNs << std::setw(12) << record.stats.medianNs << std::setw(12) << record.stats.p99Ns
+        << std::setw(10) << record.stats.stddevNs << std::setprecision(2) << std::setw(9) << gbs;
+    if (streamGBs > 0)
+        out << std::setprecision(1) << std::setw(8) << 100 * gbs / streamGBs << "%";
+    out << " ";
+    for (const auto &tag : record.tags)
+        out << " " << tag.first << "=" << tag.second;
+    out << "\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+inline std::string jsonEscape(const std::string &text)
+{
+    std::string escaped;
+    for (char ch : text)
+    {
+        if (ch == '"' || ch == '\\')
+            escaped += '\\';
+        escaped += ch;
+    }
+    return escaped;
+}
+
+// {"stream_gbs": ..., "results": [{...}, ...]}
+inline bool writeJson(const std::string &path, const std::vector<BenchRecord> &records, double streamGBs)
+{
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    out << std::setprecision(10) << "{\n  \"stream_gbs\": " << streamGBs << ",\n  \"results\": [";
+    for (std::size_t i = 0; i < records.size(); i++)
+    {
+        const BenchRecord &r = records[i];
+        const double gbs = gigabytesPerSecond(r.bytes, r.stats.medianNs);
+        out << (i ? ",\n" : "\n") << "    {\"kernel\": \"" << jsonEscape(r.kernel) << "\", \"rows\": " << r.rows
+            << ", \"cols\": " << r.cols << ", \"threads\": " << r.threads << ", \"samples\": " << r.stats.samples
+            << ", \"min_ns\": " << r.stats.minNs << ", \"median_ns\": " << r.stats.medianNs
+            << ", \"p99_ns\": " << r.stats.p99Ns << ", \"mean_ns\": " << r.stats.meanNs
+            << ", \"stddev_ns\": " << r.stats.stddevNs << ", \"bytes\": " << r.bytes << ", \"gbs\": " << gbs
+            << ", \"stream_fraction\": " << (streamGBs > 0 ? gbs / streamGBs : 0);
+        for (const auto &tag : r.tags)
+            out << ", \"" << jsonEscape(tag.first) << "\": \"" << jsonEscape(tag.second) << "\"";
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+    return true;
+}
+
+// One header row, then one row per record. Tag columns are the union of all
+// tag names in order of first appearance; records without a tag leave it empty.
+inline bool writeCsv(const std::string &path, const std::vector<BenchRecord> &records, double streamGBs)
+{
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    std::vector<std::string> tagNames;
+    for (const BenchRecord &r : records)
+        for (const auto &tag : r.tags)
+            if (std::find(tagNames.begin(), tagNames.end(), tag.first) == tagNames.end())
+                tagNames.push_back(tag.first);
+
+    out << "kernel,rows,cols,threads,samples,min_ns,median_ns,p99_ns,mean_ns,stddev_ns,bytes,gbs,stream_fraction";
+    for (const std::string &name : tagNames)
+        out << "," << name;
+    out << "\n" << std::setprecision(10);
+
+    for (const BenchRecord &r : records)
+    {
+        const double gbs = gigabytesPerSecond(r.bytes, r.stats.medianNs);
+        out << r.kernel << "," << r.rows << "," << r.cols << "," << r.threads << "," << r.stats.samples << ","
+            << r.stats.minNs << "," << r.stats.medianNs << "," << r.stats.p99Ns << "," << r.stats.meanNs << ","
+            << r.stats.stddevNs << "," << r.bytes << "," << gbs << "," << (streamGBs > 0 ? gbs / streamGBs : 0);
+        for (const std::string &name : tagNames)
+        {
+            out << ",";
+            for (const auto &tag : r.tags)
+                if (tag.first == name)
+                    out << tag.second;
+        }
+        out << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,156 @@
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "backend.h"
+#include "bench.h"
+#include "expr.h"
+#include "gemm.h"
+#include "matrix_add.h"
+#include "options.h"
+#include "rng.h"
+
+// Square size of the matrixMultiply case when --sizes does not give one: large
+// enough to be compute bound, small enough to run at every thread count.
+constexpr std::size_t BACKEND_GEMM_SIZE = 512;
+
+// Runs the same kernels on every backend built into this binary at each thread
+// count of --thread-list (default 1..--threads): matrixAdd, the fused
+// expression passes assign(out, l + r) and sum(l + r), and for f64 a
+// matrixMultiply of the first --sizes entry (default 512). Reports the median
+// time, bandwidth (GFLOP/s for gemm), speedup over the same backend at the
+// smallest thread count, and whether every backend produced the same result.
+template <typename T>
+void run(const Options &options)
+{
+    std::vector<int> threadCounts = options.threadCounts;
+    if (threadCounts.empty())
+        for (int t = 1; t <= options.threads; t++)
+            threadCounts.push_back(t);
+
+    Matrix<T> left(options.rows, options.cols, 0, options.pages), right(options.rows, options.cols, 0, options.pages),
+        result(options.rows, options.cols, 0, options.pages);
+    const bool gemm = std::is_same<T, double>::value;
+    const std::size_t gemmSize =
+        !gemm ? 0 : options.sizes.empty() ? BACKEND_GEMM_SIZE : static_cast<std::size_t>(options.sizes.front());
+    Matrix<double> gemmA(gemmSize, gemmSize), gemmB(gemmSize, gemmSize), gemmC(gemmSize, gemmSize);
+    {
+        ThreadPool pool(options.threads, options.wake);
+        fillRandom(pool, left, LEFT_STREAM, options.seed);
+        fillRandom(pool, right, RIGHT_STREAM, options.seed);
+        fillRandom(pool, gemmA, LEFT_STREAM, options.seed);
+        fillRandom(pool, gemmB, RIGHT_STREAM, options.seed);
+    }
+    const AddKernelOf<T> kernel = addKernelFor<T>(3 * result.bytes(), options.stores);
+
+    // One timed operation: its kernel name, bytes per call (flops for gemm) and
+    // body, which returns the value checked across backends.
+    struct Op
+    {
+        const char *name;
+        double work;
+        std::function<double(Backend &)> body;
+    };
+    std::vector<Op> ops = {
+        {"add", 3.0 * result.bytes(),
+         [&](Backend &backend) { return static_cast<double>(matrixAdd(backend, left, right, result, kernel)); }},
+        {"assign", 3.0 * result.bytes(),
+         [&](Backend &backend) { return static_cast<double>(assign(backend, result, left + right)); }},
+        {"sum", 2.0 * result.bytes(),
+         [&](Backend &backend) { return static_cast<double>(sum(backend, left + right)); }},
+    };
+    if (gemm)
+        ops.push_back({"gemm", 2.0 * gemmSize * gemmSize * gemmSize, [&](Backend &backend)
+                       {
+                           matrixMultiply(backend, gemmA, gemmB, gemmC);
+                           return sum(gemmC);
+                       }});
+
+    std::cout << ElementTraits<T>::name << ", " << options.rows << " x " << options.cols << ", "
+              << isaName(detectIsa()) << " kernel";
+    if (gemm)
+        std::cout << ", gemm " << gemmSize << " x " << gemmSize;
+    std::cout << "\n";
+    std::cout << "Backends:";
+    for (BackendKind kind : ALL_BACKENDS)
+        std::cout << " " << backendName(kind) << (backendAvailable(kind) ? "" : " (not built)");
+    std::cout << "\n";
+    std::cout << std::setw(11) << "backend" << std::setw(9) << "threads" << std::setw(8) << "op" << std::setw(11)
+              << "ms" << std::setw(9) << "GB/s" << std::setw(9) << "speedup" << "  check\n";
+
+    std::vector<BenchRecord> records;
+    std::vector<double> reference(ops.size());
+    std::vector<char> haveReference(ops.size(), 0);
+    bool allMatch = true;
+    for (BackendKind kind : ALL_BACKENDS)
+    {
+        if (!backendAvailable(kind))
+            continue;
+        std::vector<double> baseline(ops.size(), 0);
+        for (int threads : threadCounts)
+        {
+            std::unique_ptr<Backend> backend = makeBackend(kind, threads, options.wake);
+            // Only the pool backend's threads can be pinned; the others record "none".
+            const std::string pin = backend->threadPool() ? applyPinning(*backend->threadPool(), options)
+                                                          : pinPolicyName(PinPolicy::None);
+            for (std::size_t o = 0; o < ops.size(); o++)
+            {
+                const Op &op = ops[o];
+                const bool isGemm = std::string(op.name) == "gemm";
+                double value = 0;
+                BenchRecord record;
+                record.kernel = std::string(op.name) + "-" + backend->name();
+                record.rows = isGemm ? gemmSize : options.rows;
+                record.cols = isGemm ? gemmSize : options.cols;
+                record.threads = threads;
+                record.bytes = isGemm ? 3.0 * sizeof(double) * gemmSize * gemmSize : op.work;
+                record.stats = measure(options.warmups, options.reps, [&] { value = op.body(*backend); });
+                record.tags = {{"type", isGemm ? "f64" : ElementTraits<T>::name},
+                               {"backend", backend->name()},
+                               {"pin", pin}};
+                if (isGemm)
+                    record.tags.push_back({"gflops", std::to_string(op.work / record.stats.medianNs)});
+                records.push_back(record);
+
+                if (!haveReference[o])
+                {
+                    reference[o] = value;
+                    haveReference[o] = 1;
+                }
+                const bool match = value == reference[o];
+                allMatch = allMatch && match;
+                if (baseline[o] == 0)
+                    baseline[o] = record.stats.medianNs;
+                const double rate =
+                    isGemm ? op.work / record.stats.medianNs : gigabytesPerSecond(op.work, record.stats.medianNs);
+                std::cout << std::setw(11) << backend->name() << std::setw(9) << threads << std::setw(8) << op.name
+                          << std::fixed << std::setprecision(3) << std::setw(11) << record.stats.medianNs / 1e6
+                          << std::setprecision(2) << std::setw(9) << rate << std::setw(9)
+                          << baseline[o] / record.stats.medianNs << "  " << (match ? "ok" : "MISMATCH") << "\n";
+                std::cout.unsetf(std::ios::fixed);
+                std::cout << std::setprecision(6);
+            }
+        }
+    }
+    if (!allMatch)
+        std::cout << "Backends disagree on a result\n";
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options,
+                      OPT_SHAPE | OPT_POOL_BENCH | OPT_SIZES | OPT_STORES | OPT_THREAD_LIST | OPT_OUTPUT | OPT_TYPE |
+                      OPT_PAGES))
+        return 1;
+
+    withElementType(options.elementType, [&](auto element) { run<decltype(element)>(options); });
+    return 0;
+}
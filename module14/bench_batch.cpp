@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "batch.h"
+#include "bench.h"
+#include "matrix_add.h"
+#include "options.h"
+
+// Square shapes swept when --sizes is not given.
+constexpr int BATCH_SHAPES[] = {4, 8, 16, 32, 64};
+// Matrices timed with one pooled matrixAdd call each; that path costs a pool
+// dispatch per matrix, so it runs on a prefix of the batch and is reported
+// per matrix like the others.
+constexpr std::size_t PER_CALL_LIMIT = 20000;
+
+// Adds `count` n x n matrices four ways and reports time per matrix:
+//   pool-call - matrixAdd(pool, ...) per matrix, the existing API
+//   loop      - serial matrixAdd per matrix on the calling thread
+//   array     - matrixAddBatch over std::vector<Matrix<T>>
+//   tensor    - matrixAddBatch over a MatrixBatch
+template <typename T>
+void run(const Options &options)
+{
+    ThreadPool pool(options.threads, options.wake);
+    const std::string pin = applyPinning(pool, options);
+    std::vector<int> shapes = options.sizes;
+    if (shapes.empty())
+        shapes.assign(std::begin(BATCH_SHAPES), std::end(BATCH_SHAPES));
+
+    std::cout << ElementTraits<T>::name << ", " << pool.size() << " threads\n";
+    std::cout << std::setw(6) << "shape" << std::setw(10) << "count" << std::setw(13) << "pool-call" << std::setw(11)
+              << "loop" << std::setw(11) << "array" << std::setw(11) << "tensor" << std::setw(11) << "GB/s"
+              << std::setw(10) << "x call" << "  check\n";
+
+    std::vector<BenchRecord> records;
+    for (int n : shapes)
+    {
+        const std::size_t matrixBytes = std::size_t(n) * n * sizeof(T);
+        const std::size_t count = options.batch > 0
+                                      ? options.batch
+                                      : std::max<std::size_t>(1, (std::size_t(DEFAULT_BATCH_MB) << 20) / matrixBytes);
+
+        MatrixBatch<T> left(count, n, n), right(count, n, n), result(count, n, n);
+        fillRandom(pool, left, LEFT_STREAM, options.seed);
+        fillRandom(pool, right, RIGHT_STREAM, options.seed);
+        std::vector<Matrix<T>> leftList, rightList, resultList;
+        for (std::size_t b = 0; b < count; b++)
+        {
+            leftList.emplace_back(n, n);
+            rightList.emplace_back(n, n);
+            resultList.emplace_back(n, n);
+            for (int r = 0; r < n; r++)
+                for (int c = 0; c < n; c++)
+                {
+                    leftList[b](r, c) = left(b, r, c);
+                    rightList[b](r, c) = right(b, r, c);
+                }
+        }
+
+        const std::size_t callCount = std::min(count, PER_CALL_LIMIT);
+        AccumulatorOf<T> callSum = 0, loopSum = 0, arraySum = 0, tensorSum = 0;
+        auto time = [&](const char *kernel, std::size_t matrices, auto body)
+        {
+            BenchRecord record;
+            record.kernel = kernel;
+            record.rows = n;
+            record.cols = n;
+            record.threads = pool.size();
+            record.bytes = 3.0 * matrixBytes * matrices;
+            record.stats = measure(options.warmups, options.reps, body);
+            record.tags = {{"type", ElementTraits<T>::name}, {"count", std::to_string(matrices)}, {"pin", pin}};
+            records.push_back(record);
+            return record.stats.medianNs / matrices;
+        };
+
+        const double callNs = time("pool-call", callCount, [&]
+                                   {
+                                       callSum = 0;
+                                       for (std::size_t b = 0; b < callCount; b++)
+                                           callSum += matrixAdd(pool, leftList[b], rightList[b], resultList[b],
+                                                                options.schedule);
+                                   });
+        const double loopNs = time("loop", count, [&]
+                                   {
+                                       loopSum = 0;
+                                       for (std::size_t b = 0; b < count; b++)
+                                       {
+                                           AccumulatorOf<T> sum = 0;
+                                           matrixAdd(leftList[b], rightList[b], resultList[b], 0, n - 1, sum);
+                                           loopSum += sum;
+                                       }
+                                   });
+        const double arrayNs = time("array", count, [&]
+                                    { arraySum = matrixAddBatch(pool, leftList, rightList, resultList); });
+        const double tensorNs = time("tensor", count, [&] { tensorSum = matrixAddBatch(pool, left, right, result); });
+
+        // The pool-call prefix must match the same prefix of the serial loop.
+        AccumulatorOf<T> prefixSum = 0;
+        for (std::size_t b = 0; b < callCount; b++)
+        {
+            AccumulatorOf<T> sum = 0;
+            matrixAdd(leftList[b], rightList[b], resultList[b], 0, n - 1, sum);
+            prefixSum += sum;
+        }
+        const bool ok = callSum == prefixSum && arraySum == loopSum && tensorSum == loopSum;
+
+        std::cout << std::setw(6) << n << std::setw(10) << count << std::fixed << std::setprecision(1) << std::setw(10)
+                  << callNs << " ns" << std::setw(11) << loopNs << std::setw(11) << arrayNs << std::setw(11) << tensorNs
+                  << std::setprecision(2) << std::setw(11) << gigabytesPerSecond(3.0 * matrixBytes, tensorNs)
+                  << std::setprecision(1) << std::setw(10) << callNs / tensorNs << "  " << (ok ? "ok" : "MISMATCH")
+                  << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+    std::cout << "(times are per matrix)\n";
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options,
+                      OPT_POOL_BENCH | OPT_SCHEDULE | OPT_SIZES | OPT_OUTPUT | OPT_TYPE | OPT_BATCH))
+        return 1;
+
+    withElementType(options.elementType, [&](auto element) { run<decltype(element)>(options); });
+    return 0;
+}
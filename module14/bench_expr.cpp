@@ -0,0 +1,85 @@
+#include <iostream>
+#include "bench.h"
+#include "expr.h"
+#include "matrix_add.h"
+#include "options.h"
+#include "rng.h"
+
+// Times sum(A + 2*B - C) and D = A + 2*B - C as single fused expression passes
+// against the same chain evaluated one operation at a time through temporaries,
+// plus matrixAdd against the equivalent D = A + B expression.
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_SHAPE | OPT_POOL_BENCH | OPT_OUTPUT))
+        return 1;
+
+    const int rows = options.rows, cols = options.cols;
+    Matrix<double> a(rows, cols), b(rows, cols), c(rows, cols);
+    Matrix<double> d(rows, cols), t1(rows, cols), t2(rows, cols);
+    ThreadPool pool(options.threads, options.wake);
+    const std::string pin = applyPinning(pool, options);
+    fillRandom(pool, a, LEFT_STREAM, options.seed);
+    fillRandom(pool, b, RIGHT_STREAM, options.seed);
+    fillRandom(pool, c, RIGHT_STREAM + 1, options.seed);
+    assign(pool, d, 0.0 * a);
+    assign(pool, t1, 0.0 * a);
+    assign(pool, t2, 0.0 * a);
+
+    const double elementBytes = sizeof(double) * static_cast<double>(rows) * cols;
+    std::vector<BenchRecord> records;
+    auto record = [&](const char *kernel, const char *mode, double bytes, double result, auto body)
+    {
+        BenchRecord r;
+        r.kernel = kernel;
+        r.rows = rows;
+        r.cols = cols;
+        r.threads = pool.size();
+        r.bytes = bytes;
+        r.stats = measure(options.warmups, options.reps, body);
+        r.tags = {{"mode", mode}, {"result", std::to_string(static_cast<long long>(result))}, {"pin", pin}};
+        printRecord(std::cout, r, 0);
+        records.push_back(r);
+    };
+
+    std::cout << "Matrix: " << rows << " x " << cols << ", " << pool.size() << " threads\n";
+    printRecordHeader(std::cout, false);
+
+    double value = sum(pool, a + 2 * b - c);
+    record("sum(a+2b-c)", "fused", 3 * elementBytes, value, [&] { value = sum(pool, a + 2 * b - c); });
+
+    // Unfused: every operation streams its operands and writes a full temporary.
+    auto unfusedSum = [&]
+    {
+        assign(pool, t1, 2 * b);
+        assign(pool, t2, a + t1);
+        assign(pool, t1, t2 - c);
+        return sum(pool, t1);
+    };
+    value = unfusedSum();
+    record("sum(a+2b-c)", "temporaries", 10 * elementBytes, value, [&] { value = unfusedSum(); });
+
+    value = assign(pool, d, a + 2 * b - c);
+    record("d=a+2b-c", "fused", 4 * elementBytes, value, [&] { value = assign(pool, d, a + 2 * b - c); });
+
+    auto unfusedAssign = [&]
+    {
+        assign(pool, t1, 2 * b);
+        assign(pool, t2, a + t1);
+        return assign(pool, d, t2 - c);
+    };
+    value = unfusedAssign();
+    record("d=a+2b-c", "temporaries", 9 * elementBytes, value, [&] { value = unfusedAssign(); });
+
+    value = matrixAdd(pool, a, b, d);
+    record("d=a+b", "matrixAdd", 3 * elementBytes, value, [&] { value = matrixAdd(pool, a, b, d); });
+    value = assign(pool, d, a + b);
+    record("d=a+b", "expression", 3 * elementBytes, value, [&] { value = assign(pool, d, a + b); });
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+
+    return 0;
+}
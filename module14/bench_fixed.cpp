@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "bench.h"
+#include "expr.h"
+#include "fixed.h"
+#include "matrix_add.h"
+#include "options.h"
+#include "rng.h"
+
+// Elements processed per timed repetition, so that tiny shapes are timed over
+// many calls rather than one.
+constexpr std::size_t FIXED_ELEMENTS_PER_REP = std::size_t(1) << 20;
+
+// Times one compile-time shape: FixedMatrix add and sum against the
+// runtime-sized Matrix with the dispatched add kernel (one kernel call per row,
+// as matrixAdd does) and the expression-template sum. Reports ns per call and
+// the fixed-size speedup, and checks that both paths agree.
+template <typename T, std::size_t R, std::size_t C>
+void runShape(const Options &options, const std::string &pin, std::vector<BenchRecord> &records)
+{
+    auto left = std::make_unique<FixedMatrix<T, R, C>>();
+    auto right = std::make_unique<FixedMatrix<T, R, C>>();
+    auto result = std::make_unique<FixedMatrix<T, R, C>>();
+    fillRandom(*left, LEFT_STREAM, options.seed);
+    fillRandom(*right, RIGHT_STREAM, options.seed);
+
+    Matrix<T> dynamicLeft(R, C), dynamicRight(R, C), dynamicResult(R, C);
+    for (std::size_t r = 0; r < R; r++)
+        for (std::size_t c = 0; c < C; c++)
+        {
+            dynamicLeft(r, c) = (*left)(r, c);
+            dynamicRight(r, c) = (*right)(r, c);
+        }
+
+    const std::size_t calls = std::max<std::size_t>(1, FIXED_ELEMENTS_PER_REP / (R * C));
+    const AddKernelOf<T> kernel = activeAddKernel<T>();
+    AccumulatorOf<T> addSums[2] = {};
+    AccumulatorOf<T> reduceSums[2] = {};
+    double perCall[4] = {};
+    const char *names[4] = {"add-fixed", "add-dynamic", "sum-fixed", "sum-dynamic"};
+    for (int k = 0; k < 4; k++)
+    {
+        BenchRecord record;
+        record.kernel = names[k];
+        record.rows = R;
+        record.cols = C;
+        record.threads = 1;
+        record.bytes = (k < 2 ? 3.0 : 1.0) * sizeof(T) * R * C * calls;
+        record.stats = measure(options.warmups, options.reps, [&]
+                               {
+                                   for (std::size_t i = 0; i < calls; i++)
+                                       switch (k)
+                                       {
+                                       case 0:
+                                           addSums[0] = matrixAdd(*left, *right, *result);
+                                           break;
+                                       case 1:
+                                           matrixAdd(dynamicLeft, dynamicRight, dynamicResult, 0, R - 1, addSums[1],
+                                                     kernel);
+                                           break;
+                                       case 2:
+                                           reduceSums[0] = sum(*result);
+                                           break;
+                                       default:
+                                           reduceSums[1] = sum(dynamicResult);
+                                       }
+                               });
+        record.tags = {{"type", ElementTraits<T>::name}, {"calls", std::to_string(calls)}, {"pin", pin}};
+        records.push_back(record);
+        perCall[k] = record.stats.medianNs / calls;
+    }
+
+    // The reductions must also match the sum the add returned, which catches a
+    // reduction that wraps the same way on both sides. Floating-point sums
+    // split into different lanes, so that check allows rounding.
+    const double scale = std::max(1.0, std::abs(static_cast<double>(addSums[0])));
+    const bool sumsAgree = std::is_integral<T>::value
+                               ? reduceSums[0] == addSums[0]
+                               : std::abs(static_cast<double>(reduceSums[0] - addSums[0])) <= 1e-9 * scale;
+    bool same = addSums[0] == addSums[1] && reduceSums[0] == reduceSums[1] && sumsAgree;
+    for (std::size_t r = 0; r < R && same; r++)
+        same = std::equal(result->row(r).begin(), result->row(r).end(), dynamicResult.row(r).begin());
+
+    std::cout << std::setw(5) << R << " x " << std::setw(4) << C << std::fixed << std::setprecision(1)
+              << std::setw(11) << perCall[0] << std::setw(11) << perCall[1] << std::setprecision(2) << std::setw(7)
+              << perCall[1] / perCall[0] << std::setprecision(1) << std::setw(11) << perCall[2] << std::setw(11)
+              << perCall[3] << std::setprecision(2) << std::setw(7) << perCall[3] / perCall[2] << "  "
+              << (same ? "ok" : "MISMATCH") << "\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
+template <typename T>
+void run(const Options &options)
+{
+    // Every shape runs on this thread, worker 0 of `pinned`; its destructor
+    // restores this thread's mask.
+    ThreadPool pinned(1);
+    const std::string pin = applyPinning(pinned, options);
+    std::cout << ElementTraits<T>::name << ", " << isaName(detectIsa()) << ", pin " << pin << ", ns per call\n";
+    std::cout << std::setw(12) << "shape" << std::setw(11) << "add fixed" << std::setw(11) << "dynamic"
+              << std::setw(7) << "x" << std::setw(11) << "sum fixed" << std::setw(11) << "dynamic" << std::setw(7)
+              << "x" << "  check\n";
+
+    std::vector<BenchRecord> records;
+    runShape<T, 4, 4>(options, pin, records);
+    runShape<T, 8, 8>(options, pin, records);
+    runShape<T, 16, 16>(options, pin, records);
+    runShape<T, 32, 32>(options, pin, records);
+    runShape<T, 64, 64>(options, pin, records);
+    runShape<T, 256, 256>(options, pin, records);
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_REPS | OPT_WARMUPS | OPT_SEED | OPT_OUTPUT | OPT_TYPE | OPT_PIN))
+        return 1;
+
+    withElementType(options.elementType, [&](auto element) { run<decltype(element)>(options); });
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "gemm.h"
+#include "options.h"
+#include "rng.h"
+
+// Square sizes above this skip the naive triple loop, which would take minutes.
+constexpr int NAIVE_LIMIT = 1024;
+
+// GFLOP/s of the blocked, packed, multithreaded matrixMultiply against the naive
+// triple loop for each --sizes entry (default --rows).
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_SHAPE | OPT_POOL_BENCH | OPT_SIZES | OPT_OUTPUT))
+        return 1;
+
+    std::vector<int> sizes = options.sizes;
+    if (sizes.empty())
+        sizes.push_back(options.rows);
+
+    ThreadPool pool(options.threads, options.wake);
+    const std::string pin = applyPinning(pool, options);
+    std::cout << "GEMM, " << pool.size() << " threads, micro-kernel "
+              << (activeGemmKernel() == gemmKernel(Isa::Scalar) ? "portable" : "avx2+fma") << "\n";
+    std::cout << std::setw(7) << "size" << std::setw(10) << "kernel" << std::setw(14) << "median (ms)"
+              << std::setw(12) << "GFLOP/s" << "  check\n";
+
+    std::vector<BenchRecord> records;
+    for (int size : sizes)
+    {
+        Matrix<double> a(size, size), b(size, size), c(size, size), reference(size, size);
+        fillRandom(pool, a, LEFT_STREAM, options.seed);
+        fillRandom(pool, b, RIGHT_STREAM, options.seed);
+        const double flops = 2.0 * size * size * size;
+
+        auto report = [&](const char *kernel, const TimingStats &stats, const char *check)
+        {
+            BenchRecord record;
+            record.kernel = kernel;
+            record.rows = record.cols = size;
+            record.threads = std::string(kernel) == "naive" ? 1 : pool.size();
+            record.stats = stats;
+            record.bytes = 3.0 * sizeof(double) * size * size;
+            record.tags = {{"gflops", std::to_string(flops / stats.medianNs)}, {"check", check}, {"pin", pin}};
+            records.push_back(record);
+            std::cout << std::setw(7) << size << std::setw(10) << kernel << std::fixed << std::setprecision(2)
+                      << std::setw(14) << stats.medianNs / 1e6 << std::setw(12) << flops / stats.medianNs << "  "
+                      << check << "\n";
+            std::cout.unsetf(std::ios::fixed);
+        };
+
+        const bool runNaive = size <= NAIVE_LIMIT;
+        if (runNaive)
+            report("naive", measure(0, std::min(options.reps, 3), [&] { matrixMultiplyNaive(a, b, reference); }),
+                   "-");
+
+        TimingStats stats = measure(options.warmups, options.reps, [&] { matrixMultiply(pool, a, b, c); });
+        bool match = true;
+        if (runNaive)
+            for (int i = 0; i < size && match; i++)
+                for (int j = 0; j < size && match; j++)
+                    match = c(i, j) == reference(i, j);
+        report("blocked", stats, runNaive ? (match ? "ok" : "MISMATCH") : "-");
+    }
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+
+    return 0;
+}
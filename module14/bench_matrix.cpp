@@ -0,0 +1,117 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include "bench.h"
+#include "matrix_add.h"
+#include "options.h"
+#include "perf_counters.h"
+#include "rng.h"
+
+// Sweeps matrix sizes (--sizes), element types (--types) and thread counts
+// (--thread-list) for the pooled matrixAdd, with warm-ups and repeated
+// nanosecond timings per point, and reports bandwidth against a STREAM triad
+// measured on the same host. With several types, each point also reports its
+// speedup over the first type in the list at the same size and thread count.
+// --counters adds per-call hardware counter totals to every point's tags.
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options,
+                      OPT_SHAPE | OPT_POOL_BENCH | OPT_SCHEDULE | OPT_SIZES | OPT_THREAD_LIST | OPT_OUTPUT |
+                      OPT_STREAM_MB | OPT_TYPE | OPT_TYPES | OPT_COUNTERS))
+        return 1;
+
+    std::vector<int> threadCounts = options.threadCounts;
+    if (threadCounts.empty())
+    {
+        for (int t = 1; t < options.threads; t *= 2)
+            threadCounts.push_back(t);
+        threadCounts.push_back(options.threads);
+    }
+    const int maxThreads = *std::max_element(threadCounts.begin(), threadCounts.end());
+
+    double streamGBs = 0;
+    if (options.streamMb > 0)
+    {
+        ThreadPool pool(maxThreads);
+        const std::size_t elements = static_cast<std::size_t>(options.streamMb) * 1024 * 1024 / (3 * sizeof(double));
+        streamGBs = measureStreamTriad(pool, elements, options.reps);
+        std::cout << "STREAM triad (" << maxThreads << " threads, " << options.streamMb << " MB): " << streamGBs
+                  << " GB/s\n";
+    }
+
+    std::vector<std::pair<int, int>> shapes;
+    if (options.sizes.empty())
+        shapes.emplace_back(options.rows, options.cols);
+    for (int size : options.sizes)
+        shapes.emplace_back(size, size);
+
+    std::vector<std::string> types = options.elementTypes;
+    if (types.empty())
+        types.push_back(options.elementType);
+
+    std::vector<BenchRecord> records;
+    printRecordHeader(std::cout, streamGBs > 0);
+    for (const auto &shape : shapes)
+    {
+        std::vector<double> baselineNs;
+        for (const std::string &type : types)
+            withElementType(type, [&](auto element)
+            {
+                using T = decltype(element);
+                Matrix<T> left(shape.first, shape.second);
+                Matrix<T> right(shape.first, shape.second);
+                Matrix<T> result(shape.first, shape.second);
+                {
+                    ThreadPool pool(maxThreads);
+                    fillRandom(pool, left, LEFT_STREAM, options.seed);
+                    fillRandom(pool, right, RIGHT_STREAM, options.seed);
+                }
+
+                AccumulatorOf<T> referenceSum = 0;
+                matrixAdd(left, right, result, 0, shape.first - 1, referenceSum);
+
+                for (std::size_t t = 0; t < threadCounts.size(); t++)
+                {
+                    ThreadPool pool(threadCounts[t], options.wake);
+                    const std::string pin = applyPinning(pool, options);
+                    AccumulatorOf<T> sum = 0;
+                    BenchRecord record;
+                    record.kernel = "add";
+                    record.rows = shape.first;
+                    record.cols = shape.second;
+                    record.threads = threadCounts[t];
+                    record.bytes = 3.0 * sizeof(T) * shape.first * shape.second;
+                    PoolCounters counters(pool, options.counters);
+                    record.stats = measure(options.warmups, options.reps,
+                                           [&]
+                                           {
+                                               counters.start();
+                                               sum = matrixAdd(pool, left, right, result, options.schedule);
+                                               counters.stop();
+                                           });
+                    record.tags = {{"type", ElementTraits<T>::name},
+                                   {"schedule", scheduleName(options.schedule)},
+                                   {"isa", isaName(detectIsa())},
+                                   {"pin", pin}};
+                    for (const auto &tag : counterTags(counters))
+                        record.tags.push_back(tag);
+                    if (baselineNs.size() < threadCounts.size())
+                        baselineNs.push_back(record.stats.medianNs);
+                    else
+                        record.tags.emplace_back("speedup", std::to_string(baselineNs[t] / record.stats.medianNs));
+                    if (sum != referenceSum)
+                        record.tags.emplace_back("check", "MISMATCH");
+                    printRecord(std::cout, record, streamGBs);
+                    records.push_back(record);
+                }
+            });
+    }
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, streamGBs))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, streamGBs))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "bench.h"
+#include "matrix_add.h"
+#include "numa.h"
+#include "options.h"
+#include "pages.h"
+#include "perf_counters.h"
+#include "rng.h"
+
+// Sums `matrix` one column at a time. Once a row is 4 KB or longer every
+// element lands on a different small page, so this walk is bound by dTLB
+// reach rather than bandwidth: the case huge pages help most.
+static double columnSum(ThreadPool &pool, const Matrix<double> &matrix)
+{
+    std::vector<Padded<double>> sums(pool.size());
+    pool.parallelFor(0, static_cast<int>(matrix.cols()), [&](int worker, int begin, int end)
+                     {
+                         double sum = 0;
+                         for (int c = begin; c < end; c++)
+                             for (std::size_t r = 0; r < matrix.rows(); r++)
+                                 sum += matrix(r, c);
+                         sums[worker].value += sum;
+                     });
+    double total = 0;
+    for (const Padded<double> &sum : sums)
+        total += sum.value;
+    return total;
+}
+
+// The same workloads on 4 KB pages (--pages small) and 2 MB pages (huge:
+// hugetlb if the pool has pages reserved, otherwise THP): allocation plus
+// first touch, the streaming matrixAdd and a TLB-bound column walk. With
+// --counters each record also carries dTLB misses per call.
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_SHAPE | OPT_POOL_BENCH | OPT_SCHEDULE | OPT_OUTPUT | OPT_COUNTERS))
+        return 1;
+
+    const int rows = options.rows, cols = options.cols;
+    ThreadPool pool(options.threads, options.wake);
+    const std::string pin = applyPinning(pool, options);
+    std::cout << "Matrix: " << rows << " x " << cols << ", " << pool.size() << " threads\n";
+    std::cout << std::setw(7) << "pages" << std::setw(28) << "backing" << std::setw(14) << "touch (ms)"
+              << std::setw(12) << "add (ms)" << std::setw(12) << "add GB/s" << std::setw(14) << "column (ms)"
+              << std::setw(14) << "dTLB/column" << "\n";
+
+    std::vector<BenchRecord> records;
+    PoolCounters counters(pool, options.counters);
+    double baselineAdd = 0, baselineColumn = 0, expected = 0;
+    for (PagePolicy policy : {PagePolicy::Small, PagePolicy::Huge})
+    {
+        auto record = [&](const char *kernel, double bytes, const TimingStats &stats, PageBacking backing)
+        {
+            BenchRecord r;
+            r.kernel = kernel;
+            r.rows = rows;
+            r.cols = cols;
+            r.threads = pool.size();
+            r.bytes = bytes;
+            r.stats = stats;
+            r.tags = {{"pages", pagePolicyName(policy)}, {"backing", pageBackingName(backing)}, {"pin", pin}};
+            for (const auto &tag : counterTags(counters))
+                r.tags.push_back(tag);
+            records.push_back(r);
+        };
+        const double matrixBytes = double(rows) * Matrix<double>::paddedStride(cols) * sizeof(double);
+
+        // Allocation and first touch of one operand: page faults dominate, and a
+        // 2 MB page replaces 512 of them.
+        PageBacking touched = PageBacking::Heap;
+        counters.reset();
+        const TimingStats touch = measure(0, options.reps, [&]
+                                          {
+                                              counters.start();
+                                              Matrix<double> scratch(rows, cols, 0, policy);
+                                              parallelFill(pool, scratch, [](int, int, int) { return 1.0; });
+                                              touched = scratch.backing();
+                                              counters.stop();
+                                          });
+        record("touch", matrixBytes, touch, touched);
+
+        Matrix<double> left(rows, cols, 0, policy), right(rows, cols, 0, policy), result(rows, cols, 0, policy);
+        fillRandom(pool, left, LEFT_STREAM, options.seed);
+        fillRandom(pool, right, RIGHT_STREAM, options.seed);
+        parallelFill(pool, result, [](int, int, int) { return 0.0; });
+
+        double sum = 0;
+        counters.reset();
+        const TimingStats add = measure(options.warmups, options.reps, [&]
+                                        {
+                                            counters.start();
+                                            sum = matrixAdd(pool, left, right, result, options.schedule);
+                                            counters.stop();
+                                        });
+        record("add", 3 * matrixBytes, add, left.backing());
+
+        double column = 0;
+        counters.reset();
+        const TimingStats walk = measure(options.warmups, options.reps, [&]
+                                         {
+                                             counters.start();
+                                             column = columnSum(pool, result);
+                                             counters.stop();
+                                         });
+        record("column", matrixBytes, walk, result.backing());
+        const CounterValues total = counters.total();
+
+        if (policy == PagePolicy::Small)
+        {
+            baselineAdd = add.medianNs;
+            baselineColumn = walk.medianNs;
+            expected = sum;
+        }
+        std::cout << std::setw(7) << pagePolicyName(policy) << std::setw(28)
+                  << describeBacking(left.backing(), left.data(), left.bytes()) << std::fixed << std::setprecision(2)
+                  << std::setw(14) << touch.medianNs / 1e6 << std::setw(12) << add.medianNs / 1e6 << std::setw(12)
+                  << gigabytesPerSecond(3 * matrixBytes, add.medianNs) << std::setw(14) << walk.medianNs / 1e6;
+        if (total.has(Counter::DtlbMisses) && counters.calls() > 0)
+            std::cout << std::setprecision(0) << std::setw(14) << total[Counter::DtlbMisses] / counters.calls();
+        else
+            std::cout << std::setw(14) << "n/a";
+        std::cout << ((sum == expected && column == sum) ? "" : "  MISMATCH") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+
+        if (policy == PagePolicy::Huge)
+            std::cout << "2 MB vs 4 KB pages: add x" << std::setprecision(3) << baselineAdd / add.medianNs
+                      << ", column walk x" << baselineColumn / walk.medianNs << "\n";
+    }
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "matrix_file.h"
+#include "options.h"
+#include "pipeline.h"
+#include "rng.h"
+
+// Stand-in for the production feed: pair `sequence` of the stream is random
+// matrices LEFT_STREAM and RIGHT_STREAM under seed + sequence, generated row by
+// row on the calling (reader) thread.
+template <typename T>
+void loadPair(PipelineFrame<T> &frame, std::uint64_t seed)
+{
+    const Philox4x32 rng(seed + frame.sequence);
+    for (std::size_t r = 0; r < frame.left.rows(); r++)
+    {
+        randomRow(rng, LEFT_STREAM, r, 0, frame.left.cols(), frame.left.row(r).data());
+        randomRow(rng, RIGHT_STREAM, r, 0, frame.right.cols(), frame.right.row(r).data());
+    }
+}
+
+// Adds a stream of --frames matrix pairs (--rows x --cols), loading each pair
+// from the generator above and storing each result to a matrix file in --dir.
+// The serial run does load, add and store one pair at a time; the pipelined
+// run overlaps them with --depth frames queued between stages. Prints
+// throughput, end-to-end latency percentiles and how busy each stage was.
+template <typename T>
+void run(const Options &options)
+{
+    const std::size_t rows = options.rows, cols = options.cols;
+    const std::size_t frames = options.frames;
+    const std::string sinkPath = options.dir + "/m14_pipeline.mat";
+    MatrixFile sink = MatrixFile::create<T>(sinkPath, rows, cols);
+    ThreadPool pool(options.threads, options.wake);
+    const std::string pin = applyPinning(pool, options);
+
+    auto load = [&](PipelineFrame<T> &frame)
+    {
+        if (frame.sequence >= frames)
+            return false;
+        loadPair(frame, options.seed);
+        return true;
+    };
+    auto store = [&](const PipelineFrame<T> &frame) { sink.writeRows(0, rows, frame.result); };
+
+    // Serial reference: one frame, each stage in turn.
+    PipelineStats serial;
+    {
+        PipelineFrame<T> frame;
+        frame.left = Matrix<T>(rows, cols);
+        frame.right = Matrix<T>(rows, cols);
+        frame.result = Matrix<T>(rows, cols);
+        serial.wallNs = timeNanos([&]
+        {
+            for (frame.sequence = 0; frame.sequence < frames; frame.sequence++)
+            {
+                const double nanos = timeNanos([&]
+                {
+                    serial.read.busyNs += timeNanos([&] { load(frame); });
+                    serial.compute.busyNs += timeNanos(
+                        [&] { frame.sum = matrixAdd(pool, frame.left, frame.right, frame.result, options.schedule); });
+                    serial.write.busyNs += timeNanos([&] { store(frame); });
+                });
+                serial.latencyNs.push_back(nanos);
+                serial.sum += frame.sum;
+            }
+        });
+    }
+    const PipelineStats piped =
+        runPipeline<T>(pool, rows, cols, load, store, static_cast<std::size_t>(options.depth), options.schedule);
+    std::remove(sinkPath.c_str());
+
+    std::cout << ElementTraits<T>::name << ", " << rows << " x " << cols << ", " << frames << " pairs, depth "
+              << piped.depth << ", " << pool.size() << " threads\n";
+    std::cout << std::setw(10) << "mode" << std::setw(11) << "wall ms" << std::setw(10) << "pairs/s" << std::setw(9)
+              << "p50 ms" << std::setw(9) << "p90 ms" << std::setw(9) << "p99 ms" << std::setw(9) << "max ms"
+              << std::setw(8) << "read" << std::setw(8) << "add" << std::setw(8) << "write" << "  check\n";
+
+    std::vector<BenchRecord> records;
+    const bool same = serial.sum == piped.sum && serial.frames() == piped.frames();
+    for (int mode = 0; mode < 2; mode++)
+    {
+        const PipelineStats &stats = mode ? piped : serial;
+        const char *name = mode ? "pipelined" : "serial";
+        const double pairsPerSecond = stats.wallNs > 0 ? stats.frames() * 1e9 / stats.wallNs : 0;
+
+        BenchRecord record;
+        record.kernel = std::string("pipeline-") + name;
+        record.rows = rows;
+        record.cols = cols;
+        record.threads = pool.size();
+        record.bytes = 3.0 * sizeof(T) * rows * cols;
+        record.stats = summarize(stats.latencyNs);
+        record.tags = {{"type", ElementTraits<T>::name},
+                       {"frames", std::to_string(stats.frames())},
+                       {"depth", std::to_string(mode ? stats.depth : 0)},
+                       {"wall_ns", std::to_string(stats.wallNs)},
+                       {"pairs_per_s", std::to_string(pairsPerSecond)},
+                       {"p90_ns", std::to_string(stats.latencyPercentile(0.9))},
+                       {"read_occupancy", std::to_string(stats.occupancy(stats.read))},
+                       {"compute_occupancy", std::to_string(stats.occupancy(stats.compute))},
+                       {"write_occupancy", std::to_string(stats.occupancy(stats.write))},
+                       {"pin", pin}};
+        records.push_back(record);
+
+        std::cout << std::setw(10) << name << std::fixed << std::setprecision(1) << std::setw(11)
+                  << stats.wallNs / 1e6 << std::setw(10) << pairsPerSecond << std::setprecision(2);
+        for (double q : {0.5, 0.9, 0.99, 1.0})
+            std::cout << std::setw(9) << stats.latencyPercentile(q) / 1e6;
+        std::cout << std::setprecision(0);
+        for (const StageStats *stage : {&stats.read, &stats.compute, &stats.write})
+            std::cout << std::setw(7) << 100 * stats.occupancy(*stage) << "%";
+        std::cout << "  " << (same ? "ok" : "MISMATCH") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+
+    // Where the pipelined stages waited: a stage starved for input sits behind
+    // the bottleneck, a stage blocked on a full queue sits in front of it.
+    std::cout << "pipelined stages, % of wall: busy / starved / blocked\n" << std::fixed << std::setprecision(0);
+    const char *stageNames[3] = {"read", "add", "write"};
+    const StageStats *stages[3] = {&piped.read, &piped.compute, &piped.write};
+    for (int s = 0; s < 3; s++)
+        std::cout << std::setw(10) << stageNames[s] << std::setw(6) << 100 * stages[s]->busyNs / piped.wallNs
+                  << std::setw(6) << 100 * stages[s]->starvedNs / piped.wallNs << std::setw(6)
+                  << 100 * stages[s]->blockedNs / piped.wallNs << "\n";
+    std::cout << std::setprecision(2) << "mean queue depth: loaded " << piped.loadedDepth << ", computed "
+              << piped.computedDepth << " (capacity " << piped.depth << ")\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options,
+                      OPT_SHAPE | OPT_THREADS | OPT_SEED | OPT_WAKE | OPT_PIN | OPT_SCHEDULE | OPT_OUTPUT | OPT_DIR |
+                      OPT_FRAMES | OPT_DEPTH | OPT_TYPE))
+        return 1;
+
+    withElementType(options.elementType, [&](auto element) { run<decltype(element)>(options); });
+    return 0;
+}
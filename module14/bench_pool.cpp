@@ -0,0 +1,83 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+#include "matrix_add.h"
+#include "options.h"
+#include "rng.h"
+#include "timing.h"
+
+// Spawns one std::thread per range and joins them, as threaded.cpp used to.
+static double spawnAdd(int numThreads, const Matrix<double> &left, const Matrix<double> &right,
+                       Matrix<double> &result, bool doWork)
+{
+    const int rows = static_cast<int>(result.rows());
+    std::vector<std::thread> threads;
+    std::vector<double> sums(numThreads, 0.0);
+    for (int i = 0; i < numThreads; i++)
+    {
+        int startRow = static_cast<int>(static_cast<long long>(rows) * i / numThreads);
+        int endRow   = static_cast<int>(static_cast<long long>(rows) * (i + 1) / numThreads) - 1;
+        threads.emplace_back([&, i, startRow, endRow]
+                             {
+                                 if (doWork)
+                                     matrixAdd(left, right, result, startRow, endRow, sums[i]);
+                             });
+    }
+    double total = 0;
+    for (int i = 0; i < numThreads; i++)
+    {
+        threads[i].join();
+        total += sums[i];
+    }
+    return total;
+}
+
+static void printRow(const char *mode, double dispatch, double total, const std::string &pin)
+{
+    std::cout << std::left << std::setw(14) << mode << std::right << std::fixed << std::setprecision(1)
+              << std::setw(14) << dispatch << std::setw(14) << total - dispatch << std::setw(14) << total
+              << "  " << pin << "\n";
+}
+
+// Separates the cost of getting work onto threads (an empty dispatch) from the
+// matrixAdd compute time, for per-run std::thread spawning and both pool policies.
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_SHAPE | OPT_THREADS | OPT_REPS | OPT_SEED | OPT_PIN))
+        return 1;
+
+    Matrix<double> left(options.rows, options.cols);
+    Matrix<double> right(options.rows, options.cols);
+    Matrix<double> result(options.rows, options.cols);
+
+    {
+        ThreadPool pool(options.threads);
+        fillRandom(pool, left, LEFT_STREAM, options.seed);
+        fillRandom(pool, right, RIGHT_STREAM, options.seed);
+    }
+
+    const int numThreads = options.threads < options.rows ? options.threads : options.rows;
+    std::cout << "Matrix: " << options.rows << " x " << options.cols << ", " << numThreads
+              << " threads, median of " << options.reps << " runs (us)\n";
+    std::cout << std::left << std::setw(14) << "mode" << std::right
+              << std::setw(14) << "dispatch" << std::setw(14) << "compute" << std::setw(14) << "total" << "  pin\n";
+
+    double dispatch = medianMicros(options.reps, [&] { spawnAdd(numThreads, left, right, result, false); });
+    double total = medianMicros(options.reps, [&] { spawnAdd(numThreads, left, right, result, true); });
+    // Per-run threads are never pinned.
+    printRow("spawn/join", dispatch, total, pinPolicyName(PinPolicy::None));
+
+    for (WakePolicy policy : {WakePolicy::Park, WakePolicy::Spin})
+    {
+        ThreadPool pool(numThreads, policy);
+        const std::string pin = applyPinning(pool, options);
+        dispatch = medianMicros(options.reps, [&] { pool.run([](int) {}); });
+        total = medianMicros(options.reps, [&] { matrixAdd(pool, left, right, result); });
+        printRow(policy == WakePolicy::Park ? "pool/park" : "pool/spin", dispatch, total, pin);
+    }
+
+    return 0;
+}
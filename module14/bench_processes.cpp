@@ -0,0 +1,87 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "bench.h"
+#include "matrix_add.h"
+#include "options.h"
+#include "processes.h"
+#include "rng.h"
+
+// Adds the same shared-memory matrices with N pool threads and with N forked
+// worker processes, for N in --thread-list (default 1..--threads). Both sides
+// use the same tiles and kernel, under a static split (one block per worker)
+// and a dynamic one (DEFAULT_CHUNK tiles per grab, one socket round trip per
+// grab for processes). The overhead column charges the time the processes
+// lose to the threads to each message they exchanged.
+template <typename T>
+void run(const Options &options)
+{
+    std::vector<int> counts = options.threadCounts;
+    if (counts.empty())
+        for (int n = 1; n <= options.threads; n++)
+            counts.push_back(n);
+    const double bytes = 3.0 * sizeof(T) * options.rows * options.cols;
+
+    std::cout << ElementTraits<T>::name << ", " << options.rows << " x " << options.cols << "\n";
+    std::cout << std::setw(8) << "workers" << std::setw(10) << "schedule" << std::setw(13) << "threads ms"
+              << std::setw(13) << "process ms" << std::setw(10) << "messages" << std::setw(14) << "us/message"
+              << "  check\n";
+
+    std::vector<BenchRecord> records;
+    for (int count : counts)
+    {
+        // Fork the workers before this iteration starts any threads.
+        ProcessGroup<T> group(count, options.rows, options.cols);
+        ThreadPool pool(count, options.wake);
+        const std::string pin = applyPinning(pool, options);
+        fillRandom(pool, group.left(), LEFT_STREAM, options.seed);
+        fillRandom(pool, group.right(), RIGHT_STREAM, options.seed);
+
+        for (Schedule schedule : {Schedule::Static, Schedule::Dynamic})
+        {
+            const int chunk = schedule == Schedule::Static ? 0 : DEFAULT_CHUNK;
+            AccumulatorOf<T> sums[2] = {};
+            double medians[2] = {};
+            for (int side = 0; side < 2; side++)
+            {
+                BenchRecord record;
+                record.kernel = side ? "add-processes" : "add-threads";
+                record.rows = options.rows;
+                record.cols = options.cols;
+                record.threads = count;
+                record.bytes = bytes;
+                record.stats = measure(options.warmups, options.reps, [&]
+                                       {
+                                           sums[side] = side ? group.add(chunk)
+                                                             : matrixAdd(pool, group.left(), group.right(),
+                                                                         group.result(), schedule);
+                                       });
+                record.tags = {{"type", ElementTraits<T>::name}, {"schedule", scheduleName(schedule)}, {"pin", pin}};
+                records.push_back(record);
+                medians[side] = record.stats.medianNs;
+            }
+            std::cout << std::setw(8) << count << std::setw(10) << scheduleName(schedule) << std::fixed
+                      << std::setprecision(3) << std::setw(13) << medians[0] / 1e6 << std::setw(13)
+                      << medians[1] / 1e6 << std::setw(10) << group.messages() << std::setprecision(1)
+                      << std::setw(14) << (medians[1] - medians[0]) / 1e3 / group.messages() << "  "
+                      << (sums[0] == sums[1] ? "ok" : "MISMATCH") << "\n";
+            std::cout.unsetf(std::ios::fixed);
+            std::cout << std::setprecision(6);
+        }
+    }
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_SHAPE | OPT_POOL_BENCH | OPT_THREAD_LIST | OPT_OUTPUT | OPT_TYPE))
+        return 1;
+
+    withElementType(options.elementType, [&](auto element) { run<decltype(element)>(options); });
+    return 0;
+}
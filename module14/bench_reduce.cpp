@@ -0,0 +1,112 @@
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <vector>
+#include "bench.h"
+#include "matrix_add.h"
+#include "numa.h"
+#include "options.h"
+#include "rng.h"
+
+// Fractional values spanning several binades, so that the sum rounds and its
+// last bits depend on the order of the additions (the integer-valued matrices
+// of the other drivers sum exactly in any order).
+static void fillFractional(ThreadPool &pool, Matrix<double> &matrix, std::uint32_t stream, std::uint64_t seed)
+{
+    const Philox4x32 rng(seed);
+    parallelFill(pool, matrix, [&](int, int r, int c)
+                 {
+                     const std::uint32_t bits = randomElement(rng, stream, r, c, 1u << 24);
+                     return (1.0 + (bits & 0xffff)) / 3.0 * (1 << (bits >> 20));
+                 });
+}
+
+static std::string hexDouble(double value)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%a", value);
+    return text;
+}
+
+// Adds the same fractional matrices at every thread count of --thread-list
+// (default 1..--threads) with the fast and the reproducible reduction. Reports
+// each sum's bits, how many distinct sums each mode produced over all thread
+// counts and repetitions, and what the reproducible mode costs.
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_SHAPE | OPT_POOL_BENCH | OPT_SCHEDULE | OPT_THREAD_LIST | OPT_OUTPUT))
+        return 1;
+
+    std::vector<int> threadCounts = options.threadCounts;
+    if (threadCounts.empty())
+        for (int t = 1; t <= options.threads; t++)
+            threadCounts.push_back(t);
+
+    Matrix<double> left(options.rows, options.cols), right(options.rows, options.cols),
+        result(options.rows, options.cols);
+    {
+        ThreadPool pool(options.threads, options.wake);
+        fillFractional(pool, left, LEFT_STREAM, options.seed);
+        fillFractional(pool, right, RIGHT_STREAM, options.seed);
+    }
+
+    std::cout << "Matrix: " << options.rows << " x " << options.cols << ", " << scheduleName(options.schedule)
+              << " schedule\n";
+    std::cout << std::setw(8) << "threads" << std::setw(26) << "fast sum" << std::setw(11) << "fast (ms)"
+              << std::setw(26) << "reproducible sum" << std::setw(11) << "repr (ms)" << std::setw(9) << "cost\n";
+
+    std::vector<BenchRecord> records;
+    std::set<double> fastSums, reproducibleSums;
+    for (int threads : threadCounts)
+    {
+        ThreadPool pool(threads, options.wake);
+        const std::string pin = applyPinning(pool, options);
+        double sums[2] = {};
+        double medians[2] = {};
+        for (Reduction reduction : ALL_REDUCTIONS)
+        {
+            const int mode = static_cast<int>(reduction);
+            std::set<double> &seen = reduction == Reduction::Fast ? fastSums : reproducibleSums;
+            BenchRecord record;
+            record.kernel = std::string("add-") + reductionName(reduction);
+            record.rows = options.rows;
+            record.cols = options.cols;
+            record.threads = threads;
+            record.bytes = 3.0 * sizeof(double) * options.rows * options.cols;
+            // While timing, each call's sum only goes into reserved storage;
+            // `seen` is updated after measure() returns.
+            std::vector<double> runSums;
+            runSums.reserve(options.warmups + options.reps);
+            record.stats = measure(options.warmups, options.reps, [&]
+                                   {
+                                       sums[mode] = matrixAdd(pool, left, right, result, options.schedule, reduction);
+                                       runSums.push_back(sums[mode]);
+                                   });
+            seen.insert(runSums.begin(), runSums.end());
+            record.tags = {{"reduction", reductionName(reduction)},
+                           {"schedule", scheduleName(options.schedule)},
+                           {"sum", hexDouble(sums[mode])},
+                           {"pin", pin}};
+            records.push_back(record);
+            medians[mode] = record.stats.medianNs;
+        }
+        std::cout << std::setw(8) << threads << std::setw(26) << hexDouble(sums[0]) << std::fixed << std::setprecision(3)
+                  << std::setw(11) << medians[0] / 1e6 << std::setw(26) << hexDouble(sums[1]) << std::setw(11)
+                  << medians[1] / 1e6 << std::setprecision(1) << std::setw(8)
+                  << 100 * (medians[1] / medians[0] - 1) << "%\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+    std::cout << "Distinct sums over all runs: fast " << fastSums.size() << ", reproducible "
+              << reproducibleSums.size() << (reproducibleSums.size() == 1 ? " (bit-identical)" : " (NOT REPRODUCIBLE)")
+              << "\n";
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+
+    return reproducibleSums.size() == 1 ? 0 : 2;
+}
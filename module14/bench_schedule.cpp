@@ -0,0 +1,52 @@
+#include <iostream>
+#include <iomanip>
+#include "matrix_add.h"
+#include "options.h"
+#include "rng.h"
+#include "timing.h"
+
+// Compares the static, dynamic-chunk and work-stealing tile schedules for every
+// thread count from 1 to --threads.
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_SHAPE | OPT_THREADS | OPT_REPS | OPT_SEED | OPT_WAKE | OPT_PIN))
+        return 1;
+
+    Matrix<double> left(options.rows, options.cols);
+    Matrix<double> right(options.rows, options.cols);
+    Matrix<double> result(options.rows, options.cols);
+
+    {
+        ThreadPool pool(options.threads);
+        fillRandom(pool, left, LEFT_STREAM, options.seed);
+        fillRandom(pool, right, RIGHT_STREAM, options.seed);
+    }
+
+    double referenceSum = 0;
+    matrixAdd(left, right, result, 0, options.rows - 1, referenceSum);
+
+    const TileShape shape = defaultTileShape(options.cols, sizeof(double));
+    const double bytes = static_cast<double>(options.rows) * options.cols * 3 * sizeof(double);
+    std::cout << "Matrix: " << options.rows << " x " << options.cols << ", tiles " << shape.rows << " x "
+              << shape.cols << ", median of " << options.reps << " runs\n";
+    std::cout << std::setw(8) << "threads" << "  " << std::left << std::setw(10) << "schedule" << std::right
+              << std::setw(14) << "time (us)" << std::setw(10) << "GB/s" << "  check  pin\n";
+
+    for (int threads = 1; threads <= options.threads; threads++)
+    {
+        ThreadPool pool(threads, options.wake);
+        const std::string pin = applyPinning(pool, options);
+        for (Schedule schedule : ALL_SCHEDULES)
+        {
+            double sum = 0;
+            double micros = medianMicros(options.reps, [&] { sum = matrixAdd(pool, left, right, result, schedule); });
+            std::cout << std::setw(8) << threads << "  " << std::left << std::setw(10) << scheduleName(schedule)
+                      << std::right << std::fixed << std::setprecision(1) << std::setw(14) << micros
+                      << std::setprecision(2) << std::setw(10) << bytes / micros / 1e3
+                      << "  " << (sum == referenceSum ? "ok      " : "MISMATCH") << " " << pin << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include "matrix_add.h"
+#include "options.h"
+#include "rng.h"
+
+// Runs the single-threaded matrixAdd once per supported ISA level and reports
+// the best of --reps runs as elements/s and GB/s (two loads + one store per element).
+template <typename T>
+void run(const Options &options)
+{
+    Matrix<T> left(options.rows, options.cols);
+    Matrix<T> right(options.rows, options.cols);
+    Matrix<T> result(options.rows, options.cols);
+
+    {
+        ThreadPool pool(1);
+        fillRandom(pool, left, LEFT_STREAM, options.seed);
+        fillRandom(pool, right, RIGHT_STREAM, options.seed);
+    }
+
+    const double elements = static_cast<double>(options.rows) * options.cols;
+    const double bytes = elements * 3 * sizeof(T);
+    // The kernels run on this thread, worker 0 of `pinned`, so pinning the
+    // one-thread pool pins them; its destructor restores this thread's mask.
+    ThreadPool pinned(1);
+    const std::string pin = applyPinning(pinned, options);
+    AccumulatorOf<T> referenceSum = 0;
+    matrixAdd(left, right, result, 0, options.rows - 1, referenceSum, addKernel<T>(Isa::Scalar));
+
+    std::cout << "Matrix: " << options.rows << " x " << options.cols << " " << ElementTraits<T>::name
+              << ", best of " << options.reps << " runs, detected " << isaName(detectIsa()) << ", pin " << pin
+              << "\n";
+    std::cout << std::left << std::setw(8) << "ISA" << std::right
+              << std::setw(14) << "time (us)" << std::setw(16) << "Melem/s" << std::setw(12) << "GB/s"
+              << "  check\n";
+
+    for (Isa isa : ALL_ISAS)
+    {
+        if (!isaSupported(isa))
+        {
+            std::cout << std::left << std::setw(8) << isaName(isa) << std::right << "  not supported\n";
+            continue;
+        }
+
+        AddKernelOf<T> kernel = addKernel<T>(isa);
+        AccumulatorOf<T> sum = 0;
+        matrixAdd(left, right, result, 0, options.rows - 1, sum, kernel); // warm up
+
+        double best = 1e300;
+        for (int rep = 0; rep < options.reps; rep++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            matrixAdd(left, right, result, 0, options.rows - 1, sum, kernel);
+            auto end = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+            if (seconds < best)
+                best = seconds;
+        }
+
+        std::cout << std::left << std::setw(8) << isaName(isa) << std::right << std::fixed
+                  << std::setw(14) << std::setprecision(1) << best * 1e6
+                  << std::setw(16) << std::setprecision(1) << elements / best / 1e6
+                  << std::setw(12) << std::setprecision(2) << bytes / best / 1e9
+                  << "  " << (sum == referenceSum ? "ok" : "MISMATCH") << "\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_SHAPE | OPT_REPS | OPT_SEED | OPT_TYPE | OPT_PIN))
+        return 1;
+
+    withElementType(options.elementType, [&](auto element) { run<decltype(element)>(options); });
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "bench.h"
+#include "matrix_add.h"
+#include "numa.h"
+#include "options.h"
+#include "rng.h"
+#include "sparse.h"
+
+// Fraction of non-zero elements swept by the benchmark.
+constexpr double DENSITIES[] = {0.001, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.3, 0.5};
+// Random stream that decides which elements are non-zero; values come from
+// LEFT_STREAM / RIGHT_STREAM as elsewhere.
+constexpr std::uint32_t MASK_STREAM = 8;
+constexpr std::uint32_t MASK_RANGE = 1u << 24;
+
+// Fills `matrix` with values 1..DEFAULT_VALUE_RANGE at about `density` of its
+// positions and zeros elsewhere; deterministic in (seed, stream).
+static void fillSparse(ThreadPool &pool, Matrix<double> &matrix, std::uint32_t stream, std::uint64_t seed,
+                       double density)
+{
+    const Philox4x32 rng(seed);
+    const std::uint32_t threshold = static_cast<std::uint32_t>(density * MASK_RANGE);
+    parallelFill(pool, matrix, [&](int, int r, int c)
+                 {
+                     if (randomElement(rng, MASK_STREAM + stream, r, c, MASK_RANGE) >= threshold)
+                         return 0.0;
+                     return 1.0 + randomElement(rng, stream, r, c);
+                 });
+}
+
+// Dense matrixAdd against CSR + CSR (sparseAdd) and CSR + dense
+// (sparseDenseAdd) across a sweep of densities, reporting the speedup of each
+// sparse path and the highest density at which sparse + sparse still wins.
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_SHAPE | OPT_POOL_BENCH | OPT_OUTPUT))
+        return 1;
+
+    const int rows = options.rows, cols = options.cols;
+    ThreadPool pool(options.threads, options.wake);
+    const std::string pin = applyPinning(pool, options);
+    Matrix<double> left(rows, cols), right(rows, cols), dense(rows, cols);
+    std::cout << "Matrix: " << rows << " x " << cols << ", " << pool.size() << " threads\n";
+    std::cout << std::setw(8) << "density" << std::setw(12) << "dense (us)" << std::setw(12) << "csr+csr"
+              << std::setw(12) << "csr+dense" << std::setw(12) << "toCsr" << std::setw(10) << "x csr"
+              << std::setw(10) << "x mixed" << "  check\n";
+
+    std::vector<BenchRecord> records;
+    double crossover = 0;
+    for (double density : DENSITIES)
+    {
+        fillSparse(pool, left, LEFT_STREAM, options.seed, density);
+        fillSparse(pool, right, RIGHT_STREAM, options.seed, density);
+        CsrMatrix<double> a = toCsr(pool, left), b = toCsr(pool, right), c;
+
+        double denseSum = 0, sparseSum = 0, mixedSum = 0;
+        auto time = [&](const char *kernel, double bytes, auto body)
+        {
+            BenchRecord record;
+            record.kernel = kernel;
+            record.rows = rows;
+            record.cols = cols;
+            record.threads = pool.size();
+            record.bytes = bytes;
+            record.stats = measure(options.warmups, options.reps, body);
+            record.tags = {{"density", std::to_string(density)}, {"pin", pin}};
+            records.push_back(record);
+            return record.stats.medianNs;
+        };
+
+        const double denseBytes = 3.0 * sizeof(double) * rows * cols;
+        const double denseNs = time("dense", denseBytes, [&] { denseSum = matrixAdd(pool, left, right, dense); });
+        const double sparseNs = time("csr+csr", 0, [&] { sparseSum = sparseAdd(pool, a, b, c); });
+        // c.nnz() is only known once sparseAdd has filled c.
+        records.back().bytes = (sizeof(double) + sizeof(std::int32_t)) * (a.nnz() + b.nnz() + c.nnz());
+        const double mixedNs = time("csr+dense", denseBytes, [&] { mixedSum = sparseDenseAdd(pool, a, right, dense); });
+        const double convertNs = time("toCsr", denseBytes / 3, [&] { a = toCsr(pool, left); });
+
+        const bool ok = sparseSum == denseSum && mixedSum == denseSum && sum(pool, c) == denseSum;
+        if (sparseNs < denseNs)
+            crossover = density;
+        std::cout << std::setw(8) << density << std::fixed << std::setprecision(1) << std::setw(12) << denseNs / 1e3
+                  << std::setw(12) << sparseNs / 1e3 << std::setw(12) << mixedNs / 1e3 << std::setw(12)
+                  << convertNs / 1e3 << std::setprecision(2) << std::setw(10) << denseNs / sparseNs << std::setw(10)
+                  << denseNs / mixedNs << "  " << (ok ? "ok" : "MISMATCH") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+    if (crossover > 0)
+        std::cout << "csr+csr beats dense add up to density " << crossover << "\n";
+    else
+        std::cout << "csr+csr never beats dense add at this size\n";
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+
+    return 0;
+}
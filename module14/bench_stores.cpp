@@ -0,0 +1,82 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "bench.h"
+#include "matrix_add.h"
+#include "options.h"
+#include "rng.h"
+
+// Square sizes swept when --sizes is not given: from L2-resident to well past
+// any last-level cache.
+constexpr int STORE_SIZES[] = {256, 512, 1024, 1536, 2048, 3072, 4096};
+
+// Times matrixAdd with ordinary and with non-temporal result stores at each
+// size and reports the bandwidth of both (counting the 3 streams the add
+// needs, not the write-allocate read), the streaming speedup and the mode
+// StoreMode::Auto picks for that size.
+template <typename T>
+void run(const Options &options)
+{
+    ThreadPool pool(options.threads, options.wake);
+    const std::string pin = applyPinning(pool, options);
+    std::vector<int> sizes = options.sizes;
+    if (sizes.empty())
+        sizes.assign(std::begin(STORE_SIZES), std::end(STORE_SIZES));
+
+    const AddKernelOf<T> normal = activeAddKernel<T>();
+    const AddKernelOf<T> streaming = streamingAddKernel<T>(detectIsa());
+    std::cout << ElementTraits<T>::name << ", " << pool.size() << " threads, " << isaName(detectIsa())
+              << ", auto threshold " << streamingStoreThreshold() / 1024 << " KiB\n";
+    std::cout << std::setw(6) << "size" << std::setw(11) << "MiB" << std::setw(13) << "normal GB/s" << std::setw(13)
+              << "stream GB/s" << std::setw(9) << "x" << std::setw(9) << "auto" << "  check\n";
+
+    std::vector<BenchRecord> records;
+    for (int n : sizes)
+    {
+        Matrix<T> left(n, n), right(n, n), result(n, n);
+        fillRandom(pool, left, LEFT_STREAM, options.seed);
+        fillRandom(pool, right, RIGHT_STREAM, options.seed);
+        const double bytes = 3.0 * left.bytes();
+
+        AccumulatorOf<T> sums[2] = {};
+        double gbs[2] = {};
+        const AddKernelOf<T> kernels[2] = {normal, streaming};
+        for (int k = 0; k < 2; k++)
+        {
+            BenchRecord record;
+            record.kernel = k ? "add-stream" : "add-normal";
+            record.rows = n;
+            record.cols = n;
+            record.threads = pool.size();
+            record.bytes = bytes;
+            record.stats = measure(options.warmups, options.reps, [&]
+                                   { sums[k] = matrixAdd(pool, left, right, result, options.schedule, kernels[k]); });
+            record.tags = {{"type", ElementTraits<T>::name}, {"pin", pin}};
+            records.push_back(record);
+            gbs[k] = gigabytesPerSecond(bytes, record.stats.medianNs);
+        }
+
+        const bool autoStreams = addKernelFor<T>(static_cast<std::size_t>(bytes), StoreMode::Auto) == streaming;
+        std::cout << std::setw(6) << n << std::fixed << std::setprecision(1) << std::setw(11) << bytes / (1 << 20)
+                  << std::setprecision(2) << std::setw(13) << gbs[0] << std::setw(13) << gbs[1] << std::setw(9)
+                  << gbs[1] / gbs[0] << std::setw(9) << (autoStreams ? "stream" : "normal") << "  "
+                  << (sums[0] == sums[1] ? "ok" : "MISMATCH") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_POOL_BENCH | OPT_SCHEDULE | OPT_SIZES | OPT_OUTPUT | OPT_TYPE))
+        return 1;
+
+    withElementType(options.elementType, [&](auto element) { run<decltype(element)>(options); });
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "options.h"
+#include "rng.h"
+#include "streaming.h"
+
+// Writes random matrices LEFT_STREAM and RIGHT_STREAM to `leftPath` and
+// `rightPath` one chunk at a time, so the files may be far larger than memory,
+// and returns the sum of their element-wise sum (wrapped to T like the add).
+template <typename T>
+AccumulatorOf<T> writeRandomFiles(ThreadPool &pool, const std::string &leftPath, const std::string &rightPath,
+                                  std::size_t rows, std::size_t cols, std::uint64_t seed, std::size_t chunkRows)
+{
+    const Philox4x32 rng(seed);
+    MatrixFile leftFile = MatrixFile::create<T>(leftPath, rows, cols);
+    MatrixFile rightFile = MatrixFile::create<T>(rightPath, rows, cols);
+    Matrix<T> left(std::min(chunkRows, rows), cols), right(std::min(chunkRows, rows), cols);
+    std::vector<Padded<AccumulatorOf<T>>> sums(pool.size());
+    for (std::size_t first = 0; first < rows; first += left.rows())
+    {
+        const std::size_t count = std::min(left.rows(), rows - first);
+        pool.parallelFor(0, static_cast<int>(count), [&](int worker, int begin, int end)
+                         {
+                             for (int r = begin; r < end; r++)
+                             {
+                                 T *leftRow = left.row(r).data();
+                                 T *rightRow = right.row(r).data();
+                                 randomRow(rng, LEFT_STREAM, first + r, 0, cols, leftRow, valueRange<T>());
+                                 randomRow(rng, RIGHT_STREAM, first + r, 0, cols, rightRow, valueRange<T>());
+                                 for (std::size_t c = 0; c < cols; c++)
+                                     sums[worker].value += wrappingAdd(leftRow[c], rightRow[c]);
+                             }
+                         });
+        leftFile.writeRows(first, count, left);
+        rightFile.writeRows(first, count, right);
+    }
+    // Push the data out and evict it so the timed passes start from disk.
+    for (MatrixFile *file : {&leftFile, &rightFile})
+    {
+        file->flush();
+        file->dropRows(0, rows);
+    }
+
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &sum : sums)
+        total += sum.value;
+    return total;
+}
+
+// Out-of-core add of two --rows x --cols matrix files of --type elements
+// generated in --dir, with disk and compute throughput reported separately for
+// every repetition. Returns the process exit status.
+template <typename T>
+int run(const Options &options)
+{
+    const std::size_t rows = options.rows, cols = options.cols;
+    const std::string leftPath = options.dir + "/m14_left.mat";
+    const std::string rightPath = options.dir + "/m14_right.mat";
+    const std::string resultPath = options.dir + "/m14_result.mat";
+    const std::size_t rowBytes = Matrix<T>::paddedStride(cols) * sizeof(T);
+    const std::size_t chunkRows = std::max<std::size_t>(1, (std::size_t(options.chunkMb) << 20) / rowBytes);
+
+    ThreadPool pool(options.threads, options.wake);
+    const std::string pin = applyPinning(pool, options);
+    const double fileBytes = double(rows) * rowBytes;
+    std::cout << ElementTraits<T>::name << " matrix: " << rows << " x " << cols << " (" << std::fixed
+              << std::setprecision(2) << fileBytes / (1 << 30) << " GiB per file), " << pool.size()
+              << " threads, chunk " << chunkRows << " rows\n";
+
+    int status = 0;
+    try
+    {
+        AccumulatorOf<T> expected = 0;
+        const double writeNs = timeNanos([&]
+        { expected = writeRandomFiles<T>(pool, leftPath, rightPath, rows, cols, options.seed, chunkRows); });
+        std::cout << "Generated inputs at " << 2 * fileBytes / writeNs << " GB/s\n\n";
+
+        std::cout << std::setw(4) << "rep" << std::setw(12) << "wall (ms)" << std::setw(10) << "I/O GB/s"
+                  << std::setw(13) << "compute GB/s" << std::setw(11) << "wall GB/s" << std::setw(10) << "overlap"
+                  << "  check\n";
+        std::vector<BenchRecord> records;
+        for (int rep = 0; rep < options.reps; rep++)
+        {
+            StreamStats stats = streamingAdd<T>(pool, leftPath, rightPath, resultPath, chunkRows, options.schedule);
+            const double busyNs = stats.readNs + stats.writeNs + stats.computeNs;
+            const bool ok = stats.sum == static_cast<double>(expected);
+            status |= ok ? 0 : 2;
+            std::cout << std::setw(4) << rep << std::setw(12) << stats.wallNs / 1e6 << std::setw(10) << stats.ioGBs()
+                      << std::setw(13) << stats.computeGBs() << std::setw(11) << stats.wallGBs() << std::setw(9)
+                      << 100 * busyNs / stats.wallNs << "%  " << (ok ? "ok" : "MISMATCH") << "\n";
+
+            BenchRecord record;
+            record.kernel = "stream-add";
+            record.rows = options.rows;
+            record.cols = options.cols;
+            record.threads = pool.size();
+            record.stats = summarize({stats.wallNs});
+            record.bytes = stats.bytesRead + stats.bytesWritten;
+            record.tags = {{"type", ElementTraits<T>::name},
+                           {"io_gbs", std::to_string(stats.ioGBs())},
+                           {"compute_gbs", std::to_string(stats.computeGBs())},
+                           {"chunks", std::to_string(stats.chunks)},
+                           {"pin", pin}};
+            records.push_back(record);
+
+            // Evict the result so the next repetition writes to cold pages too.
+            MatrixFile result = MatrixFile::open(resultPath);
+            result.flush();
+            result.dropRows(0, rows);
+        }
+
+        if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+            std::cerr << "Cannot write " << options.jsonPath << "\n";
+        if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+            std::cerr << "Cannot write " << options.csvPath << "\n";
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << error.what() << "\n";
+        status = 1;
+    }
+
+    std::remove(leftPath.c_str());
+    std::remove(rightPath.c_str());
+    std::remove(resultPath.c_str());
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options,
+                      OPT_SHAPE | OPT_THREADS | OPT_REPS | OPT_SEED | OPT_WAKE | OPT_PIN | OPT_SCHEDULE | OPT_OUTPUT |
+                      OPT_DIR | OPT_CHUNK_MB | OPT_TYPE))
+        return 1;
+
+    int status = 0;
+    withElementType(options.elementType, [&](auto element) { status = run<decltype(element)>(options); });
+    return status;
+}
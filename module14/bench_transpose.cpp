@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "bench.h"
+#include "matrix_add.h"
+#include "options.h"
+#include "rng.h"
+#include "transpose.h"
+
+// Square sizes swept when --sizes is not given.
+constexpr int TRANSPOSE_SIZES[] = {512, 1024, 2048, 4096};
+
+template <typename T>
+static bool sameElements(const Matrix<T> &a, const Matrix<T> &b)
+{
+    for (std::size_t r = 0; r < a.rows(); r++)
+        if (!std::equal(a.row(r).begin(), a.row(r).end(), b.row(r).begin()))
+            return false;
+    return true;
+}
+
+// A + Bᵀ straight from the strided view, one result row per pool range: every
+// element of a result row reads a different line of B.
+template <typename T>
+static AccumulatorOf<T> addTransposedNaive(ThreadPool &pool, const Matrix<T> &left, const Matrix<T> &right,
+                                           Matrix<T> &result)
+{
+    std::vector<Padded<AccumulatorOf<T>>> sums(pool.size());
+    pool.parallelFor(0, static_cast<int>(result.rows()), [&](int worker, int begin, int end)
+                     {
+                         AccumulatorOf<T> sum = 0;
+                         for (int r = begin; r < end; r++)
+                             for (std::size_t c = 0; c < result.cols(); c++)
+                             {
+                                 result(r, c) = wrappingAdd(left(r, c), right(c, r));
+                                 sum += result(r, c);
+                             }
+                         sums[worker].value = sum;
+                     });
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &sum : sums)
+        total += sum.value;
+    return total;
+}
+
+// Times, at each size: the naive single-threaded transpose, the blocked
+// parallel transpose out of place and in place, and three ways to compute
+// A + Bᵀ: transpose into a temporary then add (two passes), a naive strided
+// loop, and the fused blocked matrixAddTransposed. Bandwidth counts 2 streams
+// for a transpose and 3 for an add. Every variant is checked against the
+// naive result.
+template <typename T>
+void run(const Options &options)
+{
+    ThreadPool pool(options.threads, options.wake);
+    const std::string pin = applyPinning(pool, options);
+    std::vector<int> sizes = options.sizes;
+    if (sizes.empty())
+        sizes.assign(std::begin(TRANSPOSE_SIZES), std::end(TRANSPOSE_SIZES));
+
+    std::cout << ElementTraits<T>::name << ", " << pool.size() << " threads, " << scheduleName(options.schedule)
+              << " schedule\n";
+    std::cout << std::setw(6) << "size" << std::setw(20) << "kernel" << std::setw(11) << "ms" << std::setw(9)
+              << "GB/s" << "  check\n";
+
+    std::vector<BenchRecord> records;
+    for (int n : sizes)
+    {
+        Matrix<T> left(n, n), right(n, n), expected(n, n), out(n, n), temporary(n, n), result(n, n);
+        fillRandom(pool, left, LEFT_STREAM, options.seed);
+        fillRandom(pool, right, RIGHT_STREAM, options.seed);
+        transposeNaive(right, expected);
+        const double matrixBytes = static_cast<double>(left.bytes());
+
+        auto report = [&](const std::string &kernel, int threads, double bytes, const TimingStats &stats, bool ok)
+        {
+            BenchRecord record;
+            record.kernel = kernel;
+            record.rows = n;
+            record.cols = n;
+            record.threads = threads;
+            record.bytes = bytes;
+            record.stats = stats;
+            record.tags = {{"type", ElementTraits<T>::name}, {"schedule", scheduleName(options.schedule)},
+                           {"pin", pin}};
+            records.push_back(record);
+            std::cout << std::setw(6) << n << std::setw(20) << kernel << std::fixed << std::setprecision(3)
+                      << std::setw(11) << stats.medianNs / 1e6 << std::setprecision(2) << std::setw(9)
+                      << gigabytesPerSecond(bytes, stats.medianNs) << "  " << (ok ? "ok" : "MISMATCH") << "\n";
+            std::cout.unsetf(std::ios::fixed);
+            std::cout << std::setprecision(6);
+        };
+
+        TimingStats stats = measure(options.warmups, options.reps, [&] { transposeNaive(right, out); });
+        report("transpose-naive", 1, 2 * matrixBytes, stats, sameElements(out, expected));
+
+        stats = measure(options.warmups, options.reps, [&] { transpose(pool, right, out, options.schedule); });
+        report("transpose-blocked", pool.size(), 2 * matrixBytes, stats, sameElements(out, expected));
+
+        // Each run transposes the previous run's output, so check a fresh copy.
+        for (int r = 0; r < n; r++)
+            std::copy(right.row(r).begin(), right.row(r).end(), out.row(r).begin());
+        transposeInPlace(pool, out, options.schedule);
+        const bool inPlaceOk = sameElements(out, expected);
+        stats = measure(options.warmups, options.reps, [&] { transposeInPlace(pool, out, options.schedule); });
+        report("transpose-inplace", pool.size(), 2 * matrixBytes, stats, inPlaceOk);
+
+        // expected becomes A + Bᵀ.
+        const AccumulatorOf<T> reference = matrixAdd(pool, left, expected, expected, options.schedule);
+        AccumulatorOf<T> sum = 0;
+        stats = measure(options.warmups, options.reps, [&]
+                        {
+                            transpose(pool, right, temporary, options.schedule);
+                            sum = matrixAdd(pool, left, temporary, result, options.schedule);
+                        });
+        report("add-two-pass", pool.size(), 5 * matrixBytes, stats,
+               sum == reference && sameElements(result, expected));
+
+        stats = measure(options.warmups, options.reps, [&] { sum = addTransposedNaive(pool, left, right, result); });
+        report("add-strided-naive", pool.size(), 3 * matrixBytes, stats,
+               sum == reference && sameElements(result, expected));
+
+        stats = measure(options.warmups, options.reps, [&]
+                        { sum = matrixAddTransposed(pool, left, right, result, options.schedule); });
+        report("add-transposed", pool.size(), 3 * matrixBytes, stats,
+               sum == reference && sameElements(result, expected));
+    }
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records, 0))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options, OPT_POOL_BENCH | OPT_SCHEDULE | OPT_SIZES | OPT_OUTPUT | OPT_TYPE))
+        return 1;
+
+    withElementType(options.elementType, [&](auto element) { run<decltype(element)>(options); });
+    return 0;
+}
@@ -0,0 +1,411 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "backend.h"
+#include "matrix.h"
+#include "scheduler.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+// Lazy elementwise expressions over Matrix<T>. Writing `A + 2 * B - C` builds a
+// small tree of value-type nodes instead of computing anything; sum(), assign()
+// and friends then walk the tree once per element, so a whole chain costs one
+// pass over memory and no temporary matrices.
+//
+// Every node exposes value_type, rows(), cols(), TERMINALS (number of matrices it
+// reads) and row(r), a cursor whose operator[](c) yields element (r, c). Row
+// cursors hold raw row pointers, so the inner column loops are plain strided
+// loads the compiler can vectorize. Operands are captured by value; leaf nodes
+// point into their Matrix, which must outlive the expression.
+
+template <typename T>
+class MatrixTerminal
+{
+public:
+    using value_type = T;
+    static constexpr int TERMINALS = 1;
+
+    explicit MatrixTerminal(const Matrix<T> &matrix)
+        : data_(matrix.data()), rows_(matrix.rows()), cols_(matrix.cols()), stride_(matrix.stride()) {}
+
+    struct Row
+    {
+        const T *data;
+        T operator[](std::size_t col) const { return data[col]; }
+    };
+
+    Row row(std::size_t row) const { return Row{data_ + row * stride_}; }
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+
+private:
+    const T *data_;
+    std::size_t rows_;
+    std::size_t cols_;
+    std::size_t stride_;
+};
+
+struct AddOp
+{
+    template <typename T>
+    static T apply(T a, T b) { return wrappingAdd(a, b); }
+};
+
+struct SubOp
+{
+    template <typename T>
+    static T apply(T a, T b) { return a - b; }
+};
+
+struct MulOp
+{
+    template <typename T>
+    static T apply(T a, T b) { return a * b; }
+};
+
+template <typename L, typename R, typename Op>
+class BinaryExpr
+{
+public:
+    using value_type = typename L::value_type;
+    static constexpr int TERMINALS = L::TERMINALS + R::TERMINALS;
+    static_assert(std::is_same<value_type, typename R::value_type>::value, "operand element types must match");
+
+    BinaryExpr(const L &left, const R &right) : left_(left), right_(right)
+    {
+        if (left.rows() != right.rows() || left.cols() != right.cols())
+            throw std::invalid_argument("Matrix expression operands have different shapes");
+    }
+
+    struct Row
+    {
+        typename L::Row left;
+        typename R::Row right;
+        value_type operator[](std::size_t col) const { return Op::apply(left[col], right[col]); }
+    };
+
+    Row row(std::size_t row) const { return Row{left_.row(row), right_.row(row)}; }
+    std::size_t rows() const { return left_.rows(); }
+    std::size_t cols() const { return left_.cols(); }
+
+private:
+    L left_;
+    R right_;
+};
+
+template <typename E>
+class ScaleExpr
+{
+public:
+    using value_type = typename E::value_type;
+    static constexpr int TERMINALS = E::TERMINALS;
+
+    ScaleExpr(value_type scale, const E &expr) : scale_(scale), expr_(expr) {}
+
+    struct Row
+    {
+        value_type scale;
+        typename E::Row inner;
+        value_type operator[](std::size_t col) const { return scale * inner[col]; }
+    };
+
+    Row row(std::size_t row) const { return Row{scale_, expr_.row(row)}; }
+    std::size_t rows() const { return expr_.rows(); }
+    std::size_t cols() const { return expr_.cols(); }
+
+private:
+    value_type scale_;
+    E expr_;
+};
+
+template <typename T>
+struct IsExpr : std::false_type {};
+template <typename T>
+struct IsExpr<MatrixTerminal<T>> : std::true_type {};
+template <typename L, typename R, typename Op>
+struct IsExpr<BinaryExpr<L, R, Op>> : std::true_type {};
+template <typename E>
+struct IsExpr<ScaleExpr<E>> : std::true_type {};
+
+template <typename T>
+struct IsMatrix : std::false_type {};
+template <typename T>
+struct IsMatrix<Matrix<T>> : std::true_type {};
+
+// Anything that may appear in an expression: a Matrix or an expression node.
+template <typename T>
+constexpr bool IS_OPERAND = IsExpr<T>::value || IsMatrix<T>::value;
+
+template <typename T>
+MatrixTerminal<T> toExpr(const Matrix<T> &matrix) { return MatrixTerminal<T>(matrix); }
+
+template <typename E, typename = std::enable_if_t<IsExpr<E>::value>>
+const E &toExpr(const E &expr) { return expr; }
+
+template <typename T>
+using ExprOf = std::decay_t<decltype(toExpr(std::declval<const T &>()))>;
+
+template <typename A, typename B, typename = std::enable_if_t<IS_OPERAND<A> && IS_OPERAND<B>>>
+BinaryExpr<ExprOf<A>, ExprOf<B>, AddOp> operator+(const A &a, const B &b)
+{
+    return {toExpr(a), toExpr(b)};
+}
+
+template <typename A, typename B, typename = std::enable_if_t<IS_OPERAND<A> && IS_OPERAND<B>>>
+BinaryExpr<ExprOf<A>, ExprOf<B>, SubOp> operator-(const A &a, const B &b)
+{
+    return {toExpr(a), toExpr(b)};
+}
+
+// Elementwise (Hadamard) product; see gemm.h for the matrix product.
+template <typename A, typename B, typename = std::enable_if_t<IS_OPERAND<A> && IS_OPERAND<B>>>
+BinaryExpr<ExprOf<A>, ExprOf<B>, MulOp> operator*(const A &a, const B &b)
+{
+    return {toExpr(a), toExpr(b)};
+}
+
+template <typename S, typename E, typename = std::enable_if_t<std::is_arithmetic<S>::value && IS_OPERAND<E>>>
+ScaleExpr<ExprOf<E>> operator*(S scale, const E &expr)
+{
+    return {static_cast<typename ExprOf<E>::value_type>(scale), toExpr(expr)};
+}
+
+template <typename S, typename E, typename = std::enable_if_t<std::is_arithmetic<S>::value && IS_OPERAND<E>>>
+ScaleExpr<ExprOf<E>> operator*(const E &expr, S scale)
+{
+    return {static_cast<typename ExprOf<E>::value_type>(scale), toExpr(expr)};
+}
+
+// Independent accumulators per row loop. Eight lanes cover an AVX-512 register
+// of doubles, and because each lane is its own variable the compiler can keep
+// them in vector registers without reassociating floating-point additions.
+constexpr int EXPR_LANES = 8;
+
+// Reduction operations used by reduceTile(). Accumulator<T> is the type the
+// lanes and the result are kept in: sums widen to AccumulatorOf<T> like the
+// add kernels, so narrow integers do not wrap; min and max stay in T.
+struct SumReduce
+{
+    template <typename T>
+    using Accumulator = AccumulatorOf<T>;
+    template <typename T>
+    static AccumulatorOf<T> identity() { return 0; }
+    template <typename A, typename T>
+    static A combine(A a, T b) { return a + b; }
+};
+
+struct MinReduce
+{
+    template <typename T>
+    using Accumulator = T;
+    template <typename T>
+    static T identity() { return std::numeric_limits<T>::max(); }
+    template <typename T>
+    static T combine(T a, T b) { return b < a ? b : a; }
+};
+
+struct MaxReduce
+{
+    template <typename T>
+    using Accumulator = T;
+    template <typename T>
+    static T identity() { return std::numeric_limits<T>::lowest(); }
+    template <typename T>
+    static T combine(T a, T b) { return a < b ? b : a; }
+};
+
+// Result type of reducing elements of type T with `Reduce`.
+template <typename Reduce, typename T>
+using ReduceResult = typename Reduce::template Accumulator<T>;
+
+// Reduces the elements of `expr` inside `tile`.
+template <typename Reduce, typename E>
+ReduceResult<Reduce, typename E::value_type> reduceTile(const E &expr, const Tile &tile)
+{
+    using T = typename E::value_type;
+    using A = ReduceResult<Reduce, T>;
+    A lanes[EXPR_LANES];
+    for (A &lane : lanes)
+        lane = Reduce::template identity<T>();
+
+    const std::size_t first = tile.col, last = tile.col + tile.cols;
+    for (int r = tile.row; r < tile.row + tile.rows; r++)
+    {
+        const typename E::Row row = expr.row(r);
+        std::size_t c = first;
+        for (; c + EXPR_LANES <= last; c += EXPR_LANES)
+            for (int j = 0; j < EXPR_LANES; j++)
+                lanes[j] = Reduce::combine(lanes[j], row[c + j]);
+        for (; c < last; c++)
+            lanes[0] = Reduce::combine(lanes[0], row[c]);
+    }
+
+    A total = lanes[0];
+    for (int j = 1; j < EXPR_LANES; j++)
+        total = Reduce::combine(total, lanes[j]);
+    return total;
+}
+
+// Writes `expr` into the tile of `out` and returns the sum of the written values.
+template <typename T, typename E>
+AccumulatorOf<T> assignTile(Matrix<T> &out, const E &expr, const Tile &tile)
+{
+    AccumulatorOf<T> lanes[EXPR_LANES] = {};
+    const std::size_t first = tile.col, last = tile.col + tile.cols;
+    for (int r = tile.row; r < tile.row + tile.rows; r++)
+    {
+        const typename E::Row row = expr.row(r);
+        T *dst = out.row(r).data();
+        std::size_t c = first;
+        for (; c + EXPR_LANES <= last; c += EXPR_LANES)
+            for (int j = 0; j < EXPR_LANES; j++)
+            {
+                T value = row[c + j];
+                dst[c + j] = value;
+                lanes[j] += value;
+            }
+        for (; c < last; c++)
+        {
+            T value = row[c];
+            dst[c] = value;
+            lanes[0] += value;
+        }
+    }
+
+    AccumulatorOf<T> total = lanes[0];
+    for (int j = 1; j < EXPR_LANES; j++)
+        total += lanes[j];
+    return total;
+}
+
+template <typename E>
+std::vector<Tile> exprTiles(const E &expr, int extraStreams)
+{
+    const int rows = static_cast<int>(expr.rows());
+    const int cols = static_cast<int>(expr.cols());
+    return makeTiles(rows, cols, defaultTileShape(cols, sizeof(typename E::value_type), E::TERMINALS + extraStreams));
+}
+
+// Reduces `expr` over the whole matrix on `pool`, one fused pass per tile.
+template <typename Reduce, typename A>
+ReduceResult<Reduce, typename ExprOf<A>::value_type> reduce(ThreadPool &pool, const A &operand,
+                                                            Schedule schedule = Schedule::WorkStealing)
+{
+    using T = typename ExprOf<A>::value_type;
+    using R = ReduceResult<Reduce, T>;
+    const ExprOf<A> &expr = toExpr(operand);
+    std::vector<Padded<R>> partials(pool.size());
+    for (Padded<R> &partial : partials)
+        partial.value = Reduce::template identity<T>();
+
+    runTiles(pool, exprTiles(expr, 0), schedule, [&](int worker, const Tile &tile)
+             { partials[worker].value = Reduce::combine(partials[worker].value, reduceTile<Reduce>(expr, tile)); });
+
+    R total = Reduce::template identity<T>();
+    for (const Padded<R> &partial : partials)
+        total = Reduce::combine(total, partial.value);
+    return total;
+}
+
+template <typename A, typename = std::enable_if_t<IS_OPERAND<A>>>
+AccumulatorOf<typename ExprOf<A>::value_type> sum(ThreadPool &pool, const A &operand)
+{
+    return reduce<SumReduce>(pool, operand);
+}
+
+template <typename A, typename = std::enable_if_t<IS_OPERAND<A>>>
+typename ExprOf<A>::value_type minElement(ThreadPool &pool, const A &operand)
+{
+    return reduce<MinReduce>(pool, operand);
+}
+
+template <typename A, typename = std::enable_if_t<IS_OPERAND<A>>>
+typename ExprOf<A>::value_type maxElement(ThreadPool &pool, const A &operand)
+{
+    return reduce<MaxReduce>(pool, operand);
+}
+
+// Single-threaded sum over the whole matrix, still fused and vectorized.
+template <typename A, typename = std::enable_if_t<IS_OPERAND<A>>>
+AccumulatorOf<typename ExprOf<A>::value_type> sum(const A &operand)
+{
+    const ExprOf<A> &expr = toExpr(operand);
+    return reduceTile<SumReduce>(expr, Tile{0, 0, static_cast<int>(expr.rows()), static_cast<int>(expr.cols())});
+}
+
+// Evaluates `expr` into `out` on `pool` in one pass and returns the sum of `out`
+// (the matrixAdd contract, generalized to any expression).
+template <typename T, typename A, typename = std::enable_if_t<IS_OPERAND<A>>>
+AccumulatorOf<T> assign(ThreadPool &pool, Matrix<T> &out, const A &operand, Schedule schedule = Schedule::WorkStealing)
+{
+    const ExprOf<A> &expr = toExpr(operand);
+    if (out.rows() != expr.rows() || out.cols() != expr.cols())
+        throw std::invalid_argument("Matrix expression assigned to a matrix of a different shape");
+
+    std::vector<Padded<AccumulatorOf<T>>> partials(pool.size());
+    runTiles(pool, exprTiles(expr, 1), schedule, [&](int worker, const Tile &tile)
+             { partials[worker].value += assignTile(out, expr, tile); });
+
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &partial : partials)
+        total += partial.value;
+    return total;
+}
+
+// The same passes on any parallel backend: the tiles are split into
+// backend.workers() contiguous runs, one per slot, like matrixAdd(backend, ...).
+template <typename Reduce, typename A>
+ReduceResult<Reduce, typename ExprOf<A>::value_type> reduce(Backend &backend, const A &operand)
+{
+    using T = typename ExprOf<A>::value_type;
+    using R = ReduceResult<Reduce, T>;
+    const ExprOf<A> &expr = toExpr(operand);
+    const std::vector<Tile> tiles = exprTiles(expr, 0);
+    std::vector<Padded<R>> partials(backend.workers());
+    for (Padded<R> &partial : partials)
+        partial.value = Reduce::template identity<T>();
+
+    backend.parallelFor(0, static_cast<int>(tiles.size()), [&](int slot, int first, int last)
+                        {
+                            for (int t = first; t < last; t++)
+                                partials[slot].value =
+                                    Reduce::combine(partials[slot].value, reduceTile<Reduce>(expr, tiles[t]));
+                        });
+
+    R total = Reduce::template identity<T>();
+    for (const Padded<R> &partial : partials)
+        total = Reduce::combine(total, partial.value);
+    return total;
+}
+
+template <typename A, typename = std::enable_if_t<IS_OPERAND<A>>>
+AccumulatorOf<typename ExprOf<A>::value_type> sum(Backend &backend, const A &operand)
+{
+    return reduce<SumReduce>(backend, operand);
+}
+
+template <typename T, typename A, typename = std::enable_if_t<IS_OPERAND<A>>>
+AccumulatorOf<T> assign(Backend &backend, Matrix<T> &out, const A &operand)
+{
+    const ExprOf<A> &expr = toExpr(operand);
+    if (out.rows() != expr.rows() || out.cols() != expr.cols())
+        throw std::invalid_argument("Matrix expression assigned to a matrix of a different shape");
+
+    const std::vector<Tile> tiles = exprTiles(expr, 1);
+    std::vector<Padded<AccumulatorOf<T>>> partials(backend.workers());
+    backend.parallelFor(0, static_cast<int>(tiles.size()), [&](int slot, int first, int last)
+                        {
+                            for (int t = first; t < last; t++)
+                                partials[slot].value += assignTile(out, expr, tiles[t]);
+                        });
+
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &partial : partials)
+        total += partial.value;
+    return total;
+}
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "expr.h"
+#include "matrix.h"
+#include "rng.h"
+#include "simd_kernels.h"
+
+// Matrix whose shape is a template parameter. The accessors match Matrix<T>,
+// so code written against rows()/cols()/row()/view() works on either, but every
+// bound is a constant: matrixAdd and the reductions below compile to
+// straight-line vector code with no loop-count checks or remainder handling
+// beyond what the shape itself needs.
+//
+// Storage is inline, cache-line aligned. Rows of at least one line are padded
+// to whole lines like Matrix<T>; shorter rows are packed densely, so a 4 x 4
+// matrix of doubles is 128 contiguous bytes rather than four padded lines.
+// Large shapes belong on the heap (std::make_unique).
+template <typename T, std::size_t R, std::size_t C>
+class alignas(CACHE_LINE_SIZE) FixedMatrix
+{
+public:
+    static_assert(R > 0 && C > 0, "FixedMatrix needs a non-empty shape");
+
+    static constexpr std::size_t ROWS = R;
+    static constexpr std::size_t COLS = C;
+    static constexpr std::size_t LINE_ELEMENTS = CACHE_LINE_SIZE / sizeof(T);
+    static constexpr std::size_t STRIDE =
+        C >= LINE_ELEMENTS && LINE_ELEMENTS > 0 ? (C + LINE_ELEMENTS - 1) / LINE_ELEMENTS * LINE_ELEMENTS : C;
+    // True when the elements form one contiguous run, so kernels can treat
+    // the matrix as a single R * C row.
+    static constexpr bool DENSE = STRIDE == C;
+
+    T &operator()(std::size_t row, std::size_t col) { return data_[row * STRIDE + col]; }
+    const T &operator()(std::size_t row, std::size_t col) const { return data_[row * STRIDE + col]; }
+
+    RowView<T> row(std::size_t row) { return RowView<T>(data_ + row * STRIDE, C); }
+    RowView<const T> row(std::size_t row) const { return RowView<const T>(data_ + row * STRIDE, C); }
+
+    TileView<T> tile(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols)
+    {
+        return TileView<T>(data_ + row * STRIDE + col, rows, cols, STRIDE);
+    }
+    TileView<const T> tile(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) const
+    {
+        return TileView<const T>(data_ + row * STRIDE + col, rows, cols, STRIDE);
+    }
+
+    StridedView<T> view() { return StridedView<T>(data_, R, C, STRIDE, 1); }
+    StridedView<const T> view() const { return StridedView<const T>(data_, R, C, STRIDE, 1); }
+    StridedView<T> transposed() { return view().transposed(); }
+    StridedView<const T> transposed() const { return view().transposed(); }
+
+    T *data() { return data_; }
+    const T *data() const { return data_; }
+    static constexpr std::size_t rows() { return R; }
+    static constexpr std::size_t cols() { return C; }
+    static constexpr std::size_t stride() { return STRIDE; }
+    static constexpr std::size_t size() { return R * C; }
+    static constexpr std::size_t bytes() { return R * STRIDE * sizeof(T); }
+
+private:
+    T data_[R * STRIDE] = {};
+};
+
+// result[i] = left[i] + right[i] for a compile-time `Count`, returning the sum
+// like the runtime add kernels. 8- and 16-bit sums stay in int32 when Count
+// is small enough that they cannot overflow; float sums are split into 16
+// independent lanes so they vectorize without reassociation.
+template <typename T, std::size_t Count>
+inline __attribute__((always_inline)) AccumulatorOf<T> fixedAddRun(const T *left, const T *right, T *result)
+{
+    constexpr std::size_t LANES = 16;
+    constexpr bool NARROW = std::is_integral<T>::value && sizeof(T) <= 2 && Count <= (std::size_t(1) << 16);
+    using Partial = std::conditional_t<NARROW, std::int32_t, AccumulatorOf<T>>;
+    if constexpr (std::is_integral<T>::value)
+    {
+        Partial sum = 0;
+        for (std::size_t i = 0; i < Count; i++)
+        {
+            const T value = wrappingAdd(left[i], right[i]);
+            result[i] = value;
+            sum += value;
+        }
+        return sum;
+    }
+    else
+    {
+        constexpr std::size_t BODY = Count / LANES * LANES;
+        Partial lanes[LANES] = {};
+        for (std::size_t i = 0; i < BODY; i += LANES)
+            for (std::size_t j = 0; j < LANES; j++)
+            {
+                const T value = left[i + j] + right[i + j];
+                result[i + j] = value;
+                lanes[j] += value;
+            }
+        for (std::size_t i = BODY; i < Count; i++)
+        {
+            const T value = left[i] + right[i];
+            result[i] = value;
+            lanes[i - BODY] += value;
+        }
+        AccumulatorOf<T> total = 0;
+        for (Partial lane : lanes)
+            total += lane;
+        return total;
+    }
+}
+
+template <typename T, std::size_t R, std::size_t C>
+inline __attribute__((always_inline)) AccumulatorOf<T>
+fixedAdd(const FixedMatrix<T, R, C> &left, const FixedMatrix<T, R, C> &right, FixedMatrix<T, R, C> &result)
+{
+    using M = FixedMatrix<T, R, C>;
+    if constexpr (M::DENSE)
+        return fixedAddRun<T, R * C>(left.data(), right.data(), result.data());
+    else
+    {
+        AccumulatorOf<T> total = 0;
+        for (std::size_t r = 0; r < R; r++)
+            total += fixedAddRun<T, C>(left.data() + r * M::STRIDE, right.data() + r * M::STRIDE,
+                                       result.data() + r * M::STRIDE);
+        return total;
+    }
+}
+
+// One build of fixedAdd per ISA level; `flatten` compiles the inlined body for
+// the wrapper's target, as for the runtime kernels in simd_kernels.cpp.
+template <typename T, std::size_t R, std::size_t C>
+AccumulatorOf<T> fixedAddBaseline(const FixedMatrix<T, R, C> &left, const FixedMatrix<T, R, C> &right,
+                                  FixedMatrix<T, R, C> &result)
+{
+    return fixedAdd(left, right, result);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template <typename T, std::size_t R, std::size_t C>
+__attribute__((flatten, target("avx2"))) AccumulatorOf<T>
+fixedAddAVX2(const FixedMatrix<T, R, C> &left, const FixedMatrix<T, R, C> &right, FixedMatrix<T, R, C> &result)
+{
+    return fixedAdd(left, right, result);
+}
+
+template <typename T, std::size_t R, std::size_t C>
+__attribute__((flatten, target("avx512f,avx512bw"))) AccumulatorOf<T>
+fixedAddAVX512(const FixedMatrix<T, R, C> &left, const FixedMatrix<T, R, C> &right, FixedMatrix<T, R, C> &result)
+{
+    return fixedAdd(left, right, result);
+}
+#endif
+
+template <typename T, std::size_t R, std::size_t C>
+using FixedAddKernel = AccumulatorOf<T> (*)(const FixedMatrix<T, R, C> &, const FixedMatrix<T, R, C> &,
+                                            FixedMatrix<T, R, C> &);
+
+// fixedAdd built for `isa` (SSE2 and Scalar share the baseline build). The
+// AVX-512 build also uses BW instructions for 8- and 16-bit lanes, so CPUs
+// with AVX512F alone get the AVX2 build, as in simd_kernels.cpp.
+template <typename T, std::size_t R, std::size_t C>
+FixedAddKernel<T, R, C> fixedAddKernel(Isa isa)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    switch (isa)
+    {
+    case Isa::AVX512:
+        return __builtin_cpu_supports("avx512bw") ? fixedAddAVX512<T, R, C> : fixedAddAVX2<T, R, C>;
+    case Isa::AVX2:   return fixedAddAVX2<T, R, C>;
+    default:          return fixedAddBaseline<T, R, C>;
+    }
+#else
+    (void)isa;
+    return fixedAddBaseline<T, R, C>;
+#endif
+}
+
+// resultMatrix = leftMatrix + rightMatrix, returning the sum of the result: the
+// matrixAdd contract with the shape fixed at compile time. The widest build
+// the CPU supports is picked once per shape.
+template <typename T, std::size_t R, std::size_t C>
+AccumulatorOf<T> matrixAdd(const FixedMatrix<T, R, C> &leftMatrix,
+                           const FixedMatrix<T, R, C> &rightMatrix,
+                           FixedMatrix<T, R, C> &resultMatrix)
+{
+    static const FixedAddKernel<T, R, C> kernel = fixedAddKernel<T, R, C>(detectIsa());
+    return kernel(leftMatrix, rightMatrix, resultMatrix);
+}
+
+// Reduces every element with one of expr.h's Reduce operations, using
+// EXPR_LANES independent lanes like reduceTile; sums widen the same way.
+template <typename Reduce, typename T, std::size_t R, std::size_t C>
+ReduceResult<Reduce, T> reduce(const FixedMatrix<T, R, C> &matrix)
+{
+    using M = FixedMatrix<T, R, C>;
+    using A = ReduceResult<Reduce, T>;
+    constexpr std::size_t RUN = M::DENSE ? R * C : C;
+    constexpr std::size_t RUNS = M::DENSE ? 1 : R;
+    constexpr std::size_t BODY = RUN / EXPR_LANES * EXPR_LANES;
+    A lanes[EXPR_LANES];
+    for (A &lane : lanes)
+        lane = Reduce::template identity<T>();
+    for (std::size_t r = 0; r < RUNS; r++)
+    {
+        const T *values = matrix.data() + r * M::STRIDE;
+        for (std::size_t i = 0; i < BODY; i += EXPR_LANES)
+            for (std::size_t j = 0; j < EXPR_LANES; j++)
+                lanes[j] = Reduce::combine(lanes[j], values[i + j]);
+        for (std::size_t i = BODY; i < RUN; i++)
+            lanes[i - BODY] = Reduce::combine(lanes[i - BODY], values[i]);
+    }
+    A total = lanes[0];
+    for (int j = 1; j < EXPR_LANES; j++)
+        total = Reduce::combine(total, lanes[j]);
+    return total;
+}
+
+// Same names and result types as the expression-template reductions.
+template <typename T, std::size_t R, std::size_t C>
+AccumulatorOf<T> sum(const FixedMatrix<T, R, C> &matrix)
+{
+    return reduce<SumReduce>(matrix);
+}
+
+template <typename T, std::size_t R, std::size_t C>
+T minElement(const FixedMatrix<T, R, C> &matrix)
+{
+    return reduce<MinReduce>(matrix);
+}
+
+template <typename T, std::size_t R, std::size_t C>
+T maxElement(const FixedMatrix<T, R, C> &matrix)
+{
+    return reduce<MaxReduce>(matrix);
+}
+
+// Fills `matrix` with random matrix `stream`: the same values fillRandom puts
+// in an R x C Matrix<T> for the same (seed, stream).
+template <typename T, std::size_t R, std::size_t C>
+void fillRandom(FixedMatrix<T, R, C> &matrix, std::uint32_t stream, std::uint64_t seed = DEFAULT_SEED,
+                std::uint32_t range = valueRange<T>())
+{
+    const Philox4x32 rng(seed);
+    for (std::size_t r = 0; r < R; r++)
+        randomRow(rng, stream, static_cast<int>(r), 0, static_cast<int>(C), matrix.row(r).data(), range);
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <stdexcept>
+#include <vector>
+#include "backend.h"
+#include "matrix.h"
+#include "scheduler.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+// Cache blocking for matrixMultiply (doubles):
+//   KC x NR sliver of packed B stays in L1 while a micro-kernel runs,
+//   MC x KC block of packed A (~192 KB) stays in L2 for a macro tile,
+//   KC x NC panel of packed B (~8 MB) is shared by all workers from L3.
+constexpr int GEMM_KC = 256;
+constexpr int GEMM_MC = 96;
+constexpr int GEMM_NC = 4096;
+// Columns of the B panel per parallel macro tile.
+constexpr int GEMM_TILE_COLS = 16 * GEMM_NR;
+
+static_assert(GEMM_MC % GEMM_MR == 0 && GEMM_NC % GEMM_NR == 0 && GEMM_TILE_COLS % GEMM_NR == 0,
+              "GEMM block sizes must be multiples of the register block");
+
+// Reference C = A * B, the textbook i-j-k triple loop.
+template <typename T>
+void matrixMultiplyNaive(const Matrix<T> &a, const Matrix<T> &b, Matrix<T> &c)
+{
+    for (std::size_t i = 0; i < a.rows(); i++)
+        for (std::size_t j = 0; j < b.cols(); j++)
+        {
+            T sum = 0;
+            for (std::size_t k = 0; k < a.cols(); k++)
+                sum += a(i, k) * b(k, j);
+            c(i, j) = sum;
+        }
+}
+
+// Packs rows [ic, ic + mc) x cols [pc, pc + kc) of A into MR-row slivers,
+// k-major within a sliver, zero-padding the last sliver to MR rows.
+inline void packA(const Matrix<double> &a, int ic, int pc, int mc, int kc, double *packed)
+{
+    for (int ir = 0; ir < mc; ir += GEMM_MR)
+        for (int k = 0; k < kc; k++)
+            for (int i = 0; i < GEMM_MR; i++)
+                *packed++ = ir + i < mc ? a(ic + ir + i, pc + k) : 0.0;
+}
+
+// Packs NR-column slivers [firstSliver, lastSliver) of rows [pc, pc + kc) x
+// cols [jc, jc + nc) of B, zero-padding the last sliver to NR columns.
+inline void packB(const Matrix<double> &b, int pc, int jc, int kc, int nc, int firstSliver, int lastSliver,
+                  double *packed)
+{
+    for (int s = firstSliver; s < lastSliver; s++)
+    {
+        const int jr = s * GEMM_NR;
+        double *out = packed + static_cast<std::size_t>(s) * kc * GEMM_NR;
+        for (int k = 0; k < kc; k++)
+        {
+            const double *row = b.row(pc + k).data() + jc + jr;
+            for (int j = 0; j < GEMM_NR; j++)
+                *out++ = jr + j < nc ? row[j] : 0.0;
+        }
+    }
+}
+
+// Runs the micro-kernel over one mc x ncols macro tile of C. Edge blocks go
+// through a scratch MR x NR tile so the kernel always sees a full block.
+inline void gemmMacroTile(GemmKernel kernel, int kc, int mc, int ncols, const double *packedA,
+                          const double *packedB, double *c, std::size_t ldc, bool accumulate)
+{
+    for (int jr = 0; jr < ncols; jr += GEMM_NR)
+    {
+        const double *b = packedB + static_cast<std::size_t>(jr) * kc;
+        const int nr = ncols - jr < GEMM_NR ? ncols - jr : GEMM_NR;
+        for (int ir = 0; ir < mc; ir += GEMM_MR)
+        {
+            const double *a = packedA + static_cast<std::size_t>(ir) * kc;
+            double *block = c + ir * ldc + jr;
+            const int mr = mc - ir < GEMM_MR ? mc - ir : GEMM_MR;
+            if (mr == GEMM_MR && nr == GEMM_NR)
+            {
+                kernel(kc, a, b, block, ldc, accumulate);
+                continue;
+            }
+
+            double scratch[GEMM_MR * GEMM_NR];
+            kernel(kc, a, b, scratch, GEMM_NR, false);
+            for (int i = 0; i < mr; i++)
+                for (int j = 0; j < nr; j++)
+                    block[i * ldc + j] = (accumulate ? block[i * ldc + j] : 0.0) + scratch[i * GEMM_NR + j];
+        }
+    }
+}
+
+// One MC x GEMM_TILE_COLS macro tile of C for the KC x NC panel (pc, jc):
+// packs the A block into `blockA` unless `packedRow` says it already holds
+// this block row, then sweeps it with the micro-kernel.
+inline void gemmPanelTile(GemmKernel kernel, const Matrix<double> &a, Matrix<double> &c, const Tile &tile, int pc,
+                          int jc, int kc, const double *packedB, double *blockA, int &packedRow)
+{
+    if (packedRow != tile.row)
+    {
+        packA(a, tile.row, pc, tile.rows, kc, blockA);
+        packedRow = tile.row;
+    }
+    gemmMacroTile(kernel, kc, tile.rows, tile.cols, blockA, packedB + static_cast<std::size_t>(tile.col) * kc,
+                  c.row(tile.row).data() + jc + tile.col, c.stride(), pc > 0);
+}
+
+inline void zeroProduct(Matrix<double> &c)
+{
+    for (std::size_t i = 0; i < c.rows(); i++)
+        for (std::size_t j = 0; j < c.cols(); j++)
+            c(i, j) = 0;
+}
+
+// C = A * B on `pool`. For every KC x NC panel of B: the panel is packed in
+// parallel, then C is cut into MC x GEMM_TILE_COLS macro tiles scheduled with
+// work stealing; each worker packs the MC x KC block of A it needs (reusing it
+// across consecutive tiles of the same block row) and sweeps it with the
+// register-blocked micro-kernel.
+inline void matrixMultiply(ThreadPool &pool, const Matrix<double> &a, const Matrix<double> &b, Matrix<double> &c,
+                           GemmKernel kernel = activeGemmKernel())
+{
+    if (a.cols() != b.rows() || c.rows() != a.rows() || c.cols() != b.cols())
+        throw std::invalid_argument("matrixMultiply: incompatible shapes");
+
+    const int m = static_cast<int>(a.rows());
+    const int n = static_cast<int>(b.cols());
+    const int k = static_cast<int>(a.cols());
+    if (k == 0)
+        return zeroProduct(c);
+
+    Matrix<double> packedB(1, static_cast<std::size_t>(GEMM_KC) * GEMM_NC);
+    Matrix<double> packedA(pool.size(), static_cast<std::size_t>(GEMM_MC) * GEMM_KC);
+    std::vector<Padded<int>> packedRow(pool.size());
+
+    for (int jc = 0; jc < n; jc += GEMM_NC)
+    {
+        const int nc = n - jc < GEMM_NC ? n - jc : GEMM_NC;
+        const int slivers = (nc + GEMM_NR - 1) / GEMM_NR;
+        const std::vector<Tile> tiles = makeTiles(m, nc, TileShape{GEMM_MC, GEMM_TILE_COLS});
+
+        for (int pc = 0; pc < k; pc += GEMM_KC)
+        {
+            const int kc = k - pc < GEMM_KC ? k - pc : GEMM_KC;
+            pool.parallelFor(0, slivers, [&](int, int first, int last)
+                             { packB(b, pc, jc, kc, nc, first, last, packedB.data()); });
+
+            for (Padded<int> &row : packedRow)
+                row.value = -1;
+            runTiles(pool, tiles, Schedule::WorkStealing, [&](int worker, const Tile &tile)
+                     {
+                         gemmPanelTile(kernel, a, c, tile, pc, jc, kc, packedB.data(), packedA.row(worker).data(),
+                                       packedRow[worker].value);
+                     });
+        }
+    }
+}
+
+// C = A * B on any parallel backend, blocked and packed as above. The macro
+// tiles of each panel are split into backend.workers() contiguous runs, one per
+// slot, so there is no work stealing; each slot packs into its own A block.
+inline void matrixMultiply(Backend &backend, const Matrix<double> &a, const Matrix<double> &b, Matrix<double> &c,
+                           GemmKernel kernel = activeGemmKernel())
+{
+    if (a.cols() != b.rows() || c.rows() != a.rows() || c.cols() != b.cols())
+        throw std::invalid_argument("matrixMultiply: incompatible shapes");
+
+    const int m = static_cast<int>(a.rows());
+    const int n = static_cast<int>(b.cols());
+    const int k = static_cast<int>(a.cols());
+    if (k == 0)
+        return zeroProduct(c);
+
+    Matrix<double> packedB(1, static_cast<std::size_t>(GEMM_KC) * GEMM_NC);
+    Matrix<double> packedA(backend.workers(), static_cast<std::size_t>(GEMM_MC) * GEMM_KC);
+
+    for (int jc = 0; jc < n; jc += GEMM_NC)
+    {
+        const int nc = n - jc < GEMM_NC ? n - jc : GEMM_NC;
+        const int slivers = (nc + GEMM_NR - 1) / GEMM_NR;
+        const std::vector<Tile> tiles = makeTiles(m, nc, TileShape{GEMM_MC, GEMM_TILE_COLS});
+
+        for (int pc = 0; pc < k; pc += GEMM_KC)
+        {
+            const int kc = k - pc < GEMM_KC ? k - pc : GEMM_KC;
+            backend.parallelFor(0, slivers, [&](int, int first, int last)
+                                { packB(b, pc, jc, kc, nc, first, last, packedB.data()); });
+            backend.parallelFor(0, static_cast<int>(tiles.size()), [&](int slot, int first, int last)
+                                {
+                                    int packedRow = -1;
+                                    for (int t = first; t < last; t++)
+                                        gemmPanelTile(kernel, a, c, tiles[t], pc, jc, kc, packedB.data(),
+                                                      packedA.row(slot).data(), packedRow);
+                                });
+        }
+    }
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include "pages.h"
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// Contiguous view of one matrix row.
+template <typename T>
+class RowView
+{
+public:
+    RowView(T *data, std::size_t cols) : data_(data), cols_(cols) {}
+
+    T &operator[](std::size_t col) const { return data_[col]; }
+    T *data() const { return data_; }
+    T *begin() const { return data_; }
+    T *end() const { return data_ + cols_; }
+    std::size_t size() const { return cols_; }
+
+private:
+    T *data_;
+    std::size_t cols_;
+};
+
+// Rectangular sub-block of a matrix that shares the parent's storage and stride.
+template <typename T>
+class TileView
+{
+public:
+    TileView(T *data, std::size_t rows, std::size_t cols, std::size_t stride)
+        : data_(data), rows_(rows), cols_(cols), stride_(stride) {}
+
+    T &operator()(std::size_t row, std::size_t col) const { return data_[row * stride_ + col]; }
+    RowView<T> row(std::size_t row) const { return RowView<T>(data_ + row * stride_, cols_); }
+
+    T *data() const { return data_; }
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    std::size_t stride() const { return stride_; }
+
+private:
+    T *data_;
+    std::size_t rows_;
+    std::size_t cols_;
+    std::size_t stride_;
+};
+
+// Read or write view of a rows x cols matrix whose element (r, c) lives at
+// data[r * rowStride + c * colStride]. A row-major matrix has colStride 1;
+// transposed() swaps the shape and the strides, so the transpose of a matrix
+// is just another view of the same storage.
+template <typename T>
+class StridedView
+{
+public:
+    StridedView(T *data, std::size_t rows, std::size_t cols, std::ptrdiff_t rowStride, std::ptrdiff_t colStride)
+        : data_(data), rows_(rows), cols_(cols), rowStride_(rowStride), colStride_(colStride) {}
+
+    // A writable view converts to a read-only one.
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U *, T *>::value>>
+    StridedView(const StridedView<U> &other)
+        : StridedView(other.data(), other.rows(), other.cols(), other.rowStride(), other.colStride()) {}
+
+    T &operator()(std::size_t row, std::size_t col) const
+    {
+        return data_[static_cast<std::ptrdiff_t>(row) * rowStride_ + static_cast<std::ptrdiff_t>(col) * colStride_];
+    }
+
+    StridedView transposed() const { return StridedView(data_, cols_, rows_, colStride_, rowStride_); }
+    StridedView block(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) const
+    {
+        return StridedView(&(*this)(row, col), rows, cols, rowStride_, colStride_);
+    }
+
+    T *data() const { return data_; }
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    std::ptrdiff_t rowStride() const { return rowStride_; }
+    std::ptrdiff_t colStride() const { return colStride_; }
+    bool rowContiguous() const { return colStride_ == 1; }
+
+private:
+    T *data_;
+    std::size_t rows_;
+    std::size_t cols_;
+    std::ptrdiff_t rowStride_;
+    std::ptrdiff_t colStride_;
+};
+
+// Runtime-sized, row-major matrix with cache-line-aligned storage.
+// Each row starts `stride` elements after the previous one; by default the
+// stride is the column count rounded up so every row begins on a cache line.
+// `pages` picks heap, huge-page or 4 KB mmap storage; backing() reports which
+// one the allocator actually obtained.
+template <typename T>
+class Matrix
+{
+public:
+    Matrix() = default;
+
+    Matrix(std::size_t rows, std::size_t cols, std::size_t stride = 0, PagePolicy pages = PagePolicy::Heap)
+        : rows_(rows), cols_(cols), stride_(stride ? stride : paddedStride(cols))
+    {
+        if (stride_ < cols_)
+            throw std::invalid_argument("Matrix stride must be at least the column count");
+        if (rows_ * stride_ == 0)
+            return;
+        const PageAllocation allocation = allocatePages(rows_ * stride_ * sizeof(T), pages);
+        data_ = std::unique_ptr<T, PageDelete>(static_cast<T *>(allocation.data), PageDelete{allocation});
+    }
+
+    // Adopts `storage` (e.g. a shared-memory mapping), which must hold rows x
+    // stride elements and is released with freePages.
+    Matrix(std::size_t rows, std::size_t cols, std::size_t stride, const PageAllocation &storage)
+        : rows_(rows), cols_(cols), stride_(stride),
+          data_(static_cast<T *>(storage.data), PageDelete{storage})
+    {
+        if (stride_ < cols_ || storage.bytes < rows_ * stride_ * sizeof(T))
+            throw std::invalid_argument("Matrix storage is smaller than rows x stride");
+    }
+
+    Matrix(Matrix &&) noexcept = default;
+    Matrix &operator=(Matrix &&) noexcept = default;
+    Matrix(const Matrix &) = delete;
+    Matrix &operator=(const Matrix &) = delete;
+
+    T &operator()(std::size_t row, std::size_t col) { return data_.get()[row * stride_ + col]; }
+    const T &operator()(std::size_t row, std::size_t col) const { return data_.get()[row * stride_ + col]; }
+
+    RowView<T> row(std::size_t row) { return RowView<T>(data_.get() + row * stride_, cols_); }
+    RowView<const T> row(std::size_t row) const { return RowView<const T>(data_.get() + row * stride_, cols_); }
+
+    TileView<T> tile(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols)
+    {
+        return TileView<T>(data_.get() + row * stride_ + col, rows, cols, stride_);
+    }
+    TileView<const T> tile(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) const
+    {
+        return TileView<const T>(data_.get() + row * stride_ + col, rows, cols, stride_);
+    }
+
+    StridedView<T> view() { return StridedView<T>(data_.get(), rows_, cols_, stride_, 1); }
+    StridedView<const T> view() const { return StridedView<const T>(data_.get(), rows_, cols_, stride_, 1); }
+    StridedView<T> transposed() { return view().transposed(); }
+    StridedView<const T> transposed() const { return view().transposed(); }
+
+    T *data() { return data_.get(); }
+    const T *data() const { return data_.get(); }
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    std::size_t stride() const { return stride_; }
+    std::size_t size() const { return rows_ * cols_; }
+    std::size_t bytes() const { return rows_ * stride_ * sizeof(T); }
+    PageBacking backing() const { return data_.get_deleter().allocation.backing; }
+
+    static std::size_t paddedStride(std::size_t cols)
+    {
+        const std::size_t perLine = CACHE_LINE_SIZE / sizeof(T);
+        return perLine ? (cols + perLine - 1) / perLine * perLine : cols;
+    }
+
+private:
+    // Remembers how the storage was obtained so it is released the same way.
+    struct PageDelete
+    {
+        PageAllocation allocation;
+        void operator()(T *) const { freePages(allocation); }
+    };
+
+    std::size_t rows_ = 0;
+    std::size_t cols_ = 0;
+    std::size_t stride_ = 0;
+    std::unique_ptr<T, PageDelete> data_;
+};
@@ -1,24 +1,131 @@
 #pragma once
 
-#define NUM_ROWS 1000
-#define NUM_COLS 1000
-#define NUM_THREADS 4
+#include <vector>
+#include "backend.h"
+#include "matrix.h"
+#include "reduce.h"
+#include "scheduler.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
 
-void matrixAdd(double leftMatrix[NUM_ROWS][NUM_COLS],
-               double rightMatrix[NUM_ROWS][NUM_COLS],
-               double resultMatrix[NUM_ROWS][NUM_COLS],
+// Adds rows [startRow, endRow] of leftMatrix and rightMatrix into resultMatrix
+// and stores the sum of those result elements in `sum`. Each row is handed to
+// `kernel`, which defaults to the widest vector kernel the CPU supports. The sum
+// is taken in the element type's widened accumulator (int64 for integers).
+template <typename T>
+void matrixAdd(const Matrix<T> &leftMatrix,
+               const Matrix<T> &rightMatrix,
+               Matrix<T> &resultMatrix,
                int startRow,
                int endRow,
-               double &sum)
+               AccumulatorOf<T> &sum,
+               AddKernelOf<T> kernel = activeAddKernel<T>())
 {
+    const std::size_t numCols = resultMatrix.cols();
     sum = 0;
     for (int row = startRow; row <= endRow; row++)
-    {
-        for (int col = 0; col < NUM_COLS; col++)
-        {
-            int value = leftMatrix[row][col] + rightMatrix[row][col];
-            resultMatrix[row][col] = value;
-            sum += value;
-        }
-    }
+        sum += kernel(leftMatrix.row(row).data(), rightMatrix.row(row).data(),
+                      resultMatrix.row(row).data(), numCols);
+}
+
+// Adds one tile of leftMatrix and rightMatrix into resultMatrix and returns its sum.
+template <typename T>
+AccumulatorOf<T> matrixAddTile(const Matrix<T> &leftMatrix,
+                               const Matrix<T> &rightMatrix,
+                               Matrix<T> &resultMatrix,
+                               const Tile &tile,
+                               AddKernelOf<T> kernel = activeAddKernel<T>())
+{
+    AccumulatorOf<T> sum = 0;
+    for (int row = tile.row; row < tile.row + tile.rows; row++)
+        sum += kernel(leftMatrix.row(row).data() + tile.col, rightMatrix.row(row).data() + tile.col,
+                      resultMatrix.row(row).data() + tile.col, tile.cols);
+    return sum;
+}
+
+// Adds the whole matrix on `pool` by splitting it into cache-sized tiles that are
+// handed out according to `schedule`, and returns the total sum. Per-worker
+// partial sums sit on separate cache lines.
+template <typename T>
+AccumulatorOf<T> matrixAdd(ThreadPool &pool,
+                           const Matrix<T> &leftMatrix,
+                           const Matrix<T> &rightMatrix,
+                           Matrix<T> &resultMatrix,
+                           Schedule schedule = Schedule::WorkStealing,
+                           AddKernelOf<T> kernel = activeAddKernel<T>())
+{
+    std::vector<Padded<AccumulatorOf<T>>> sums(pool.size());
+
+    const int rows = static_cast<int>(resultMatrix.rows());
+    const int cols = static_cast<int>(resultMatrix.cols());
+    std::vector<Tile> tiles = makeTiles(rows, cols, defaultTileShape(cols, sizeof(T)));
+    runTiles(pool, tiles, schedule, [&](int worker, const Tile &tile)
+             { sums[worker].value += matrixAddTile(leftMatrix, rightMatrix, resultMatrix, tile, kernel); });
+
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &sum : sums)
+        total += sum.value;
+    return total;
+}
+
+// matrixAdd with a sum that is bit-identical for every thread count and
+// schedule (Reduction::Reproducible): each tile's sum lands in its own slot and
+// the slots are combined with pairwiseSum in tile order. The result still
+// depends on `kernel`, whose vector lanes fix the order inside a row.
+template <typename T>
+AccumulatorOf<T> matrixAddReproducible(ThreadPool &pool,
+                                       const Matrix<T> &leftMatrix,
+                                       const Matrix<T> &rightMatrix,
+                                       Matrix<T> &resultMatrix,
+                                       Schedule schedule = Schedule::WorkStealing,
+                                       AddKernelOf<T> kernel = activeAddKernel<T>())
+{
+    const int rows = static_cast<int>(resultMatrix.rows());
+    const int cols = static_cast<int>(resultMatrix.cols());
+    const TileShape shape = defaultTileShape(cols, sizeof(T));
+    const int tilesPerRow = (cols + shape.cols - 1) / shape.cols;
+    std::vector<Tile> tiles = makeTiles(rows, cols, shape);
+    std::vector<AccumulatorOf<T>> tileSums(tiles.size());
+    runTiles(pool, tiles, schedule, [&](int, const Tile &tile)
+             {
+                 const int index = tile.row / shape.rows * tilesPerRow + tile.col / shape.cols;
+                 tileSums[index] = matrixAddTile(leftMatrix, rightMatrix, resultMatrix, tile, kernel);
+             });
+    return pairwiseSum(tileSums);
+}
+
+// Dispatches to matrixAdd or matrixAddReproducible.
+template <typename T>
+AccumulatorOf<T> matrixAdd(ThreadPool &pool,
+                           const Matrix<T> &leftMatrix,
+                           const Matrix<T> &rightMatrix,
+                           Matrix<T> &resultMatrix,
+                           Schedule schedule,
+                           Reduction reduction,
+                           AddKernelOf<T> kernel = activeAddKernel<T>())
+{
+    if (reduction == Reduction::Reproducible)
+        return matrixAddReproducible(pool, leftMatrix, rightMatrix, resultMatrix, schedule, kernel);
+    return matrixAdd(pool, leftMatrix, rightMatrix, resultMatrix, schedule, kernel);
+}
+
+// Adds the whole matrix on any parallel backend: rows are split into
+// backend.workers() contiguous bands, one per slot, and each slot's sum goes to
+// its own cache line. The same kernel runs on every backend, so only the
+// runtime's overhead differs.
+template <typename T>
+AccumulatorOf<T> matrixAdd(Backend &backend,
+                           const Matrix<T> &leftMatrix,
+                           const Matrix<T> &rightMatrix,
+                           Matrix<T> &resultMatrix,
+                           AddKernelOf<T> kernel = activeAddKernel<T>())
+{
+    std::vector<Padded<AccumulatorOf<T>>> sums(backend.workers());
+    backend.parallelFor(0, static_cast<int>(resultMatrix.rows()), [&](int slot, int begin, int end)
+                        { matrixAdd(leftMatrix, rightMatrix, resultMatrix, begin, end - 1, sums[slot].value, kernel); });
+
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &sum : sums)
+        total += sum.value;
+    return total;
 }
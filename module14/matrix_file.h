@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include "matrix.h"
+
+// On-disk matrix: a fixed 64-byte header followed, at dataOffset, by `rows`
+// rows of `stride` elements each (the in-memory Matrix<T> layout, padding
+// included), so a block of rows moves between file and Matrix in one call.
+constexpr char MATRIX_FILE_MAGIC[8] = {'M', '1', '4', 'M', 'A', 'T', 'R', 'X'};
+constexpr std::uint32_t MATRIX_FILE_VERSION = 1;
+// Data starts on a page boundary so whole-page reads and mappings line up.
+constexpr std::uint32_t MATRIX_FILE_ALIGNMENT = 4096;
+
+// Element type codes stored in the header.
+enum class DType : std::uint32_t
+{
+    Float64 = 1,
+    Float32 = 2,
+    Int32 = 3,
+    Int16 = 4,
+    Int8 = 5,
+    UInt8 = 6
+};
+
+template <typename T>
+struct DTypeOf;
+
+#define MODULE14_DTYPE(T, CODE)                  \
+    template <>                                  \
+    struct DTypeOf<T>                            \
+    {                                            \
+        static constexpr DType value = DType::CODE; \
+    };
+
+MODULE14_DTYPE(double, Float64)
+MODULE14_DTYPE(float, Float32)
+MODULE14_DTYPE(std::int32_t, Int32)
+MODULE14_DTYPE(std::int16_t, Int16)
+MODULE14_DTYPE(std::int8_t, Int8)
+MODULE14_DTYPE(std::uint8_t, UInt8)
+
+#undef MODULE14_DTYPE
+
+struct MatrixFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t dtype;
+    std::uint32_t elementSize;
+    std::uint32_t alignment;
+    std::uint64_t rows;
+    std::uint64_t cols;
+    std::uint64_t stride;
+    std::uint64_t dataOffset;
+    std::uint8_t reserved[8];
+};
+
+static_assert(sizeof(MatrixFileHeader) == 64, "MatrixFileHeader must stay 64 bytes");
+
+// Open matrix file; reads and writes whole rows with pread/pwrite. Move-only.
+class MatrixFile
+{
+public:
+    // Creates (or truncates) `path` sized for a rows x cols matrix of T.
+    template <typename T>
+    static MatrixFile create(const std::string &path, std::size_t rows, std::size_t cols)
+    {
+        MatrixFileHeader header{};
+        std::memcpy(header.magic, MATRIX_FILE_MAGIC, sizeof(header.magic));
+        header.version = MATRIX_FILE_VERSION;
+        header.dtype = static_cast<std::uint32_t>(DTypeOf<T>::value);
+        header.elementSize = sizeof(T);
+        header.alignment = MATRIX_FILE_ALIGNMENT;
+        header.rows = rows;
+        header.cols = cols;
+        header.stride = Matrix<T>::paddedStride(cols);
+        header.dataOffset = MATRIX_FILE_ALIGNMENT;
+
+        MatrixFile file(path, ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644));
+        file.header_ = header;
+        file.transfer(true, &header, sizeof(header), 0);
+        if (::ftruncate(file.fd_, static_cast<off_t>(header.dataOffset + file.rowBytes() * rows)) != 0)
+            file.fail("resize");
+        return file;
+    }
+
+    // Opens an existing file and validates its header.
+    static MatrixFile open(const std::string &path, bool writable = false)
+    {
+        MatrixFile file(path, ::open(path.c_str(), writable ? O_RDWR : O_RDONLY));
+        file.transfer(false, &file.header_, sizeof(file.header_), 0);
+        const MatrixFileHeader &h = file.header_;
+        if (std::memcmp(h.magic, MATRIX_FILE_MAGIC, sizeof(h.magic)) != 0 || h.version != MATRIX_FILE_VERSION)
+            throw std::runtime_error(path + ": not a matrix file");
+        if (h.stride < h.cols || h.dataOffset < sizeof(h) || h.elementSize == 0)
+            throw std::runtime_error(path + ": corrupt matrix header");
+        return file;
+    }
+
+    MatrixFile(MatrixFile &&other) noexcept : path_(std::move(other.path_)), fd_(other.fd_), header_(other.header_)
+    {
+        other.fd_ = -1;
+    }
+    MatrixFile &operator=(MatrixFile &&) = delete;
+
+    ~MatrixFile()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    const std::string &path() const { return path_; }
+    const MatrixFileHeader &header() const { return header_; }
+    DType dtype() const { return static_cast<DType>(header_.dtype); }
+    std::size_t rows() const { return header_.rows; }
+    std::size_t cols() const { return header_.cols; }
+    std::size_t stride() const { return header_.stride; }
+    std::size_t rowBytes() const { return header_.stride * header_.elementSize; }
+
+    // Reads file rows [firstRow, firstRow + count) into rows [0, count) of `into`.
+    template <typename T>
+    void readRows(std::size_t firstRow, std::size_t count, Matrix<T> &into)
+    {
+        checkBlock(firstRow, count, into, DTypeOf<T>::value);
+        transfer(false, into.data(), count * rowBytes(), rowOffset(firstRow));
+    }
+
+    // Writes rows [0, count) of `from` to file rows [firstRow, firstRow + count).
+    template <typename T>
+    void writeRows(std::size_t firstRow, std::size_t count, const Matrix<T> &from)
+    {
+        checkBlock(firstRow, count, from, DTypeOf<T>::value);
+        transfer(true, const_cast<T *>(from.data()), count * rowBytes(), rowOffset(firstRow));
+    }
+
+    // Page-cache hints for a streaming pass: read ahead aggressively, and drop
+    // rows already consumed so a file larger than RAM does not evict the rest.
+    void adviseSequential() { ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL); }
+    // Forces written rows to disk (dirty pages cannot be dropped).
+    void flush()
+    {
+        if (::fdatasync(fd_) != 0)
+            fail("sync");
+    }
+    // Forces rows [firstRow, firstRow + count) to disk and waits for them, so a
+    // streaming writer pays for its own writeback instead of leaving it dirty.
+    void syncRows(std::size_t firstRow, std::size_t count)
+    {
+#ifdef __linux__
+        if (::sync_file_range(fd_, static_cast<off_t>(rowOffset(firstRow)), static_cast<off_t>(count * rowBytes()),
+                              SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER) != 0)
+            fail("sync");
+#else
+        (void)firstRow;
+        (void)count;
+        flush();
+#endif
+    }
+    void dropRows(std::size_t firstRow, std::size_t count)
+    {
+        ::posix_fadvise(fd_, static_cast<off_t>(rowOffset(firstRow)), static_cast<off_t>(count * rowBytes()),
+                        POSIX_FADV_DONTNEED);
+    }
+
+private:
+    MatrixFile(std::string path, int fd) : path_(std::move(path)), fd_(fd), header_{}
+    {
+        if (fd_ < 0)
+            fail("open");
+    }
+
+    std::size_t rowOffset(std::size_t row) const { return header_.dataOffset + row * rowBytes(); }
+
+    template <typename T>
+    void checkBlock(std::size_t firstRow, std::size_t count, const Matrix<T> &matrix, DType type) const
+    {
+        if (dtype() != type || matrix.stride() != header_.stride || count > matrix.rows() ||
+            firstRow + count > header_.rows)
+            throw std::invalid_argument(path_ + ": row block does not match the file layout");
+    }
+
+    // pread/pwrite loop that resumes after short transfers and EINTR.
+    void transfer(bool write, void *buffer, std::size_t bytes, std::size_t offset)
+    {
+        char *p = static_cast<char *>(buffer);
+        while (bytes > 0)
+        {
+            ssize_t done = write ? ::pwrite(fd_, p, bytes, static_cast<off_t>(offset))
+                                 : ::pread(fd_, p, bytes, static_cast<off_t>(offset));
+            if (done < 0 && errno == EINTR)
+                continue;
+            if (done == 0)
+                errno = EIO;
+            if (done <= 0)
+                fail(write ? "write" : "read (truncated file?)");
+            p += done;
+            offset += static_cast<std::size_t>(done);
+            bytes -= static_cast<std::size_t>(done);
+        }
+    }
+
+    [[noreturn]] void fail(const char *what) const
+    {
+        throw std::runtime_error(path_ + ": " + what + " failed: " + std::strerror(errno));
+    }
+
+    std::string path_;
+    int fd_;
+    MatrixFileHeader header_;
+};
+
+// Writes `matrix` to `path` in matrix file format.
+template <typename T>
+void writeMatrixFile(const std::string &path, const Matrix<T> &matrix)
+{
+    MatrixFile file = MatrixFile::create<T>(path, matrix.rows(), matrix.cols());
+    file.writeRows(0, matrix.rows(), matrix);
+}
+
+// Loads a whole matrix file into memory.
+template <typename T>
+Matrix<T> readMatrixFile(const std::string &path)
+{
+    MatrixFile file = MatrixFile::open(path);
+    Matrix<T> matrix(file.rows(), file.cols());
+    file.readRows(0, file.rows(), matrix);
+    return matrix;
+}
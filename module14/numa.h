@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <vector>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "matrix.h"
+#include "scheduler.h"
+#include "thread_pool.h"
+
+// Writes fn(worker, row, col) into every element of `matrix`, tile by tile, with
+// the Static schedule. The work-stealing and static schedules start each worker
+// on the same tiles, so under Linux first-touch placement every page lands on
+// the NUMA node of the worker that will later add it.
+template <typename T, typename Fn>
+void parallelFill(ThreadPool &pool, Matrix<T> &matrix, Fn fn)
+{
+    const int rows = static_cast<int>(matrix.rows());
+    const int cols = static_cast<int>(matrix.cols());
+    std::vector<Tile> tiles = makeTiles(rows, cols, defaultTileShape(cols, sizeof(T)));
+    runTiles(pool, tiles, Schedule::Static, [&](int worker, const Tile &tile)
+             {
+                 for (int r = tile.row; r < tile.row + tile.rows; r++)
+                 {
+                     T *row = matrix.row(r).data();
+                     for (int c = tile.col; c < tile.col + tile.cols; c++)
+                         row[c] = fn(worker, r, c);
+                 }
+             });
+}
+
+// Number of pages of a buffer resident on each NUMA node.
+struct NumaPlacement
+{
+    bool available = false;           // false when the kernel refused both queries
+    std::map<int, std::size_t> nodes; // node -> page count
+    std::size_t untouched = 0;        // pages never faulted in
+};
+
+// Asks the kernel which node backs each page of [data, data + bytes). Uses
+// move_pages(2) in query mode (no target nodes); if that is unavailable it falls
+// back to get_mempolicy(2) with MPOL_F_NODE | MPOL_F_ADDR one page at a time.
+inline NumaPlacement numaPlacement(const void *data, std::size_t bytes)
+{
+    NumaPlacement placement;
+    const std::uintptr_t pageSize = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(data) & ~(pageSize - 1);
+    const std::uintptr_t last = reinterpret_cast<std::uintptr_t>(data) + bytes;
+    if (bytes == 0)
+        return placement;
+
+#if defined(SYS_move_pages) && defined(SYS_get_mempolicy)
+    const std::size_t batch = 4096;
+    std::vector<void *> pages;
+    std::vector<int> status;
+    bool movePagesWorks = true;
+    for (std::uintptr_t base = first; base < last && movePagesWorks; base += batch * pageSize)
+    {
+        pages.clear();
+        for (std::uintptr_t page = base; page < last && pages.size() < batch; page += pageSize)
+            pages.push_back(reinterpret_cast<void *>(page));
+        status.assign(pages.size(), 0);
+        if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0)
+        {
+            movePagesWorks = false;
+            break;
+        }
+        for (int node : status)
+        {
+            if (node >= 0)
+                placement.nodes[node]++;
+            else
+                placement.untouched++;
+        }
+    }
+    if (movePagesWorks)
+    {
+        placement.available = true;
+        return placement;
+    }
+
+    const unsigned long mpolFNode = 1UL << 0; // MPOL_F_NODE
+    const unsigned long mpolFAddr = 1UL << 1; // MPOL_F_ADDR
+    placement.nodes.clear();
+    placement.untouched = 0;
+    for (std::uintptr_t page = first; page < last; page += pageSize)
+    {
+        int node = -1;
+        if (syscall(SYS_get_mempolicy, &node, nullptr, 0UL, reinterpret_cast<void *>(page), mpolFNode | mpolFAddr) != 0)
+            return NumaPlacement{};
+        placement.nodes[node]++;
+    }
+    placement.available = true;
+#endif
+    return placement;
+}
+
+inline void printNumaPlacement(std::ostream &out, const char *label, const void *data, std::size_t bytes)
+{
+    NumaPlacement placement = numaPlacement(data, bytes);
+    out << "NUMA " << label << ":";
+    if (!placement.available)
+    {
+        out << " unavailable\n";
+        return;
+    }
+    for (const auto &entry : placement.nodes)
+        out << " node" << entry.first << "=" << entry.second;
+    if (placement.untouched)
+        out << " untouched=" << placement.untouched;
+    out << " pages\n";
+}
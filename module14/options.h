@@ -0,0 +1,358 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pages.h"
+#include "reduce.h"
+#include "rng.h"
+#include "simd_kernels.h"
+#include "scheduler.h"
+#include "thread_pool.h"
+#include "topology.h"
+
+#define DEFAULT_ROWS 1000
+#define DEFAULT_COLS 1000
+#define DEFAULT_THREADS 4
+#define DEFAULT_REPS 10
+#define DEFAULT_WARMUPS 3
+#define DEFAULT_STREAM_MB 256
+#define DEFAULT_CHUNK_MB 64
+#define DEFAULT_BATCH_MB 32
+#define DEFAULT_FRAMES 64
+
+// Command-line settings shared by the module14 executables.
+struct Options
+{
+    int rows = DEFAULT_ROWS;
+    int cols = DEFAULT_COLS;
+    int threads = DEFAULT_THREADS;
+    int reps = DEFAULT_REPS;
+    WakePolicy wake = WakePolicy::Park;
+    Schedule schedule = Schedule::WorkStealing;
+    Reduction reduction = Reduction::Fast;
+    StoreMode stores = StoreMode::Auto; // normal vs non-temporal result stores
+    bool numaReport = false;
+    bool counters = false; // sample hardware counters around each kernel call
+    PinPolicy pin = PinPolicy::None;
+    std::vector<int> cpuList; // CPUs for PinPolicy::List
+    PagePolicy pages = PagePolicy::Heap; // backing of the operand matrices
+    std::uint64_t seed = DEFAULT_SEED;
+    int warmups = DEFAULT_WARMUPS;
+    std::vector<int> sizes;        // square sizes to sweep; empty = just rows x cols
+    std::vector<int> threadCounts; // thread counts to sweep; empty = just threads
+    std::string jsonPath;
+    std::string csvPath;
+    std::string svgPath;
+    int streamMb = DEFAULT_STREAM_MB; // total STREAM array footprint, 0 = skip
+    std::string dir = ".";            // scratch directory for matrix files
+    int chunkMb = DEFAULT_CHUNK_MB;   // per-operand buffer of out-of-core passes
+    std::string elementType = "f64";  // matrix element type, an ELEMENT_TYPE_NAMES entry
+    std::vector<std::string> elementTypes; // element types to sweep; empty = just elementType
+    int batch = 0;                    // matrices per batch, 0 = about DEFAULT_BATCH_MB per operand
+    int frames = DEFAULT_FRAMES;      // matrix pairs in a pipelined stream
+    int depth = 2;                    // pipeline queue capacity between stages
+};
+
+// Groups of command-line flags. Each executable passes the groups it actually
+// reads to parseOptions, which rejects every other flag, and printUsage lists
+// only those.
+enum OptionGroup : std::uint32_t
+{
+    OPT_SHAPE = 1u << 0,        // --rows, --cols, --size
+    OPT_THREADS = 1u << 1,      // --threads
+    OPT_REPS = 1u << 2,         // --reps
+    OPT_WARMUPS = 1u << 3,      // --warmups
+    OPT_SEED = 1u << 4,         // --seed
+    OPT_WAKE = 1u << 5,         // --wake
+    OPT_SCHEDULE = 1u << 6,     // --schedule
+    OPT_REDUCTION = 1u << 7,    // --reduction
+    OPT_STORES = 1u << 8,       // --stores
+    OPT_SIZES = 1u << 9,        // --sizes
+    OPT_THREAD_LIST = 1u << 10, // --thread-list
+    OPT_OUTPUT = 1u << 11,      // --json, --csv
+    OPT_SVG = 1u << 12,         // --svg
+    OPT_STREAM_MB = 1u << 13,   // --stream-mb
+    OPT_DIR = 1u << 14,         // --dir
+    OPT_CHUNK_MB = 1u << 15,    // --chunk-mb
+    OPT_TYPE = 1u << 16,        // --type
+    OPT_TYPES = 1u << 17,       // --types
+    OPT_BATCH = 1u << 18,       // --batch
+    OPT_FRAMES = 1u << 19,      // --frames
+    OPT_DEPTH = 1u << 20,       // --depth
+    OPT_PIN = 1u << 21,         // --pin, --cpus
+    OPT_PAGES = 1u << 22,       // --pages
+    OPT_NUMA_REPORT = 1u << 23, // --numa-report
+    OPT_COUNTERS = 1u << 24     // --counters
+};
+
+// Flags accepted by every benchmark that times a pool with repetitions.
+constexpr std::uint32_t OPT_POOL_BENCH = OPT_THREADS | OPT_REPS | OPT_WARMUPS | OPT_SEED | OPT_WAKE | OPT_PIN;
+
+struct OptionHelp
+{
+    const char *flag;
+    std::uint32_t group;
+    std::string usage;
+};
+
+inline const std::vector<OptionHelp> &optionHelp()
+{
+    static const std::vector<OptionHelp> help = {
+        {"--rows", OPT_SHAPE,
+         "  --rows N          number of matrix rows    (default " + std::to_string(DEFAULT_ROWS) + ")"},
+        {"--cols", OPT_SHAPE,
+         "  --cols N          number of matrix columns (default " + std::to_string(DEFAULT_COLS) + ")"},
+        {"--size", OPT_SHAPE, "  --size N          square matrix, sets rows and cols"},
+        {"--threads", OPT_THREADS,
+         "  --threads N       worker thread count      (default " + std::to_string(DEFAULT_THREADS) +
+             ", 0 = all cores)"},
+        {"--reps", OPT_REPS,
+         "  --reps N          timed repetitions        (default " + std::to_string(DEFAULT_REPS) + ")"},
+        {"--wake", OPT_WAKE, "  --wake park|spin  idle worker policy       (default park)"},
+        {"--schedule", OPT_SCHEDULE, "  --schedule S      static|dynamic|steal     (default steal)"},
+        {"--reduction", OPT_REDUCTION, "  --reduction R     fast|reproducible sum    (default fast)"},
+        {"--stores", OPT_STORES, "  --stores S        auto|normal|stream       (default auto)"},
+        {"--seed", OPT_SEED,
+         "  --seed N          matrix data seed         (default " + std::to_string(DEFAULT_SEED) + ")"},
+        {"--warmups", OPT_WARMUPS,
+         "  --warmups N       untimed warm-up runs     (default " + std::to_string(DEFAULT_WARMUPS) + ")"},
+        {"--sizes", OPT_SIZES, "  --sizes L         comma-separated square sizes to sweep"},
+        {"--thread-list", OPT_THREAD_LIST, "  --thread-list L   comma-separated thread counts to sweep"},
+        {"--json", OPT_OUTPUT, "  --json PATH       write results as JSON"},
+        {"--csv", OPT_OUTPUT, "  --csv PATH        write results as CSV"},
+        {"--svg", OPT_SVG, "  --svg PATH        write a chart as SVG"},
+        {"--stream-mb", OPT_STREAM_MB, "  --stream-mb N     STREAM triad footprint   (default " +
+                                           std::to_string(DEFAULT_STREAM_MB) + ", 0 = skip)"},
+        {"--dir", OPT_DIR, "  --dir PATH        scratch directory for matrix files (default .)"},
+        {"--chunk-mb", OPT_CHUNK_MB,
+         "  --chunk-mb N      out-of-core chunk size   (default " + std::to_string(DEFAULT_CHUNK_MB) + ")"},
+        {"--type", OPT_TYPE, "  --type T          f64|f32|i32|i16|i8|u8    (default f64)"},
+        {"--types", OPT_TYPES, "  --types L         comma-separated element types to sweep"},
+        {"--batch", OPT_BATCH,
+         "  --batch N         matrices per batch (default ~" + std::to_string(DEFAULT_BATCH_MB) + " MB per operand)"},
+        {"--frames", OPT_FRAMES,
+         "  --frames N        matrix pairs per stream  (default " + std::to_string(DEFAULT_FRAMES) + ")"},
+        {"--depth", OPT_DEPTH, "  --depth N         pipeline queue capacity  (default 2)"},
+        {"--pin", OPT_PIN, "  --pin P           none|compact|scatter|cores (default none)"},
+        {"--cpus", OPT_PIN, "  --cpus L          pin worker i to the i-th CPU of a list like 0-3,8"},
+        {"--pages", OPT_PAGES, "  --pages P         heap|huge|small matrix pages (default heap)"},
+        {"--numa-report", OPT_NUMA_REPORT, "  --numa-report     print NUMA node placement of each matrix"},
+        {"--counters", OPT_COUNTERS, "  --counters        per-worker hardware counters (perf_event_open)"},
+    };
+    return help;
+}
+
+// Lists the flags in `groups`.
+inline void printUsage(const char *program, std::uint32_t groups)
+{
+    std::cerr << "Usage: " << program << " [options]\n";
+    for (const OptionHelp &option : optionHelp())
+        if (option.group & groups)
+            std::cerr << option.usage << "\n";
+}
+
+// Parses a comma-separated list of positive integers.
+inline bool parseIntList(const std::string &text, std::vector<int> &values)
+{
+    values.clear();
+    std::size_t pos = 0;
+    while (pos <= text.size())
+    {
+        std::size_t comma = text.find(',', pos);
+        if (comma == std::string::npos)
+            comma = text.size();
+        int value = std::atoi(text.substr(pos, comma - pos).c_str());
+        if (value <= 0)
+            return false;
+        values.push_back(value);
+        pos = comma + 1;
+    }
+    return !values.empty();
+}
+
+// Parses a comma-separated list of element type names.
+inline bool parseTypeList(const std::string &text, std::vector<std::string> &names)
+{
+    names.clear();
+    std::size_t pos = 0;
+    while (pos <= text.size())
+    {
+        std::size_t comma = text.find(',', pos);
+        if (comma == std::string::npos)
+            comma = text.size();
+        names.push_back(text.substr(pos, comma - pos));
+        if (!withElementType(names.back(), [](auto) {}))
+            return false;
+        pos = comma + 1;
+    }
+    return true;
+}
+
+inline bool parseWakePolicy(const std::string &text, WakePolicy &policy)
+{
+    if (text != "park" && text != "spin")
+        return false;
+    policy = text == "spin" ? WakePolicy::Spin : WakePolicy::Park;
+    return true;
+}
+
+inline bool parseSchedule(const std::string &text, Schedule &schedule)
+{
+    for (Schedule candidate : ALL_SCHEDULES)
+        if (text == scheduleName(candidate))
+        {
+            schedule = candidate;
+            return true;
+        }
+    return false;
+}
+
+// Parses argv into `options`, accepting only the flags in `groups` (OptionGroup
+// bits). Returns false (after printing usage) on bad or unsupported input.
+inline bool parseOptions(int argc, char *argv[], Options &options, std::uint32_t groups)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help")
+        {
+            printUsage(argv[0], groups);
+            return false;
+        }
+        const std::vector<OptionHelp> &known = optionHelp();
+        auto option = std::find_if(known.begin(), known.end(), [&](const OptionHelp &o) { return arg == o.flag; });
+        if (option == known.end() || !(option->group & groups))
+        {
+            std::cerr << (option == known.end() ? "Unknown option " : "Option not used by this program: ") << arg
+                      << "\n";
+            printUsage(argv[0], groups);
+            return false;
+        }
+        if (arg == "--numa-report")
+        {
+            options.numaReport = true;
+            continue;
+        }
+        if (arg == "--counters")
+        {
+            options.counters = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << arg << "\n";
+            printUsage(argv[0], groups);
+            return false;
+        }
+
+        std::string text = argv[++i];
+        int value = std::atoi(text.c_str());
+        bool valid = true;
+        if (arg == "--rows")
+            options.rows = value;
+        else if (arg == "--cols")
+            options.cols = value;
+        else if (arg == "--size")
+            options.rows = options.cols = value;
+        else if (arg == "--threads")
+            options.threads = value;
+        else if (arg == "--reps")
+            options.reps = value;
+        else if (arg == "--seed")
+            options.seed = std::strtoull(text.c_str(), nullptr, 10);
+        else if (arg == "--warmups")
+            options.warmups = value;
+        else if (arg == "--sizes")
+            valid = parseIntList(text, options.sizes);
+        else if (arg == "--thread-list")
+            valid = parseIntList(text, options.threadCounts);
+        else if (arg == "--json")
+            options.jsonPath = text;
+        else if (arg == "--csv")
+            options.csvPath = text;
+        else if (arg == "--svg")
+            options.svgPath = text;
+        else if (arg == "--stream-mb")
+            options.streamMb = value;
+        else if (arg == "--dir")
+            options.dir = text;
+        else if (arg == "--chunk-mb")
+            options.chunkMb = value;
+        else if (arg == "--type")
+        {
+            options.elementType = text;
+            valid = withElementType(text, [](auto) {});
+        }
+        else if (arg == "--types")
+            valid = parseTypeList(text, options.elementTypes);
+        else if (arg == "--batch")
+        {
+            options.batch = value;
+            valid = value > 0;
+        }
+        else if (arg == "--frames")
+        {
+            options.frames = value;
+            valid = value > 0;
+        }
+        else if (arg == "--depth")
+        {
+            options.depth = value;
+            valid = value > 0;
+        }
+        else if (arg == "--pin")
+            valid = parsePinPolicy(text, options.pin) && options.pin != PinPolicy::List;
+        else if (arg == "--cpus")
+        {
+            valid = parseCpuList(text, options.cpuList);
+            options.pin = PinPolicy::List;
+        }
+        else if (arg == "--pages")
+            valid = parsePagePolicy(text, options.pages);
+        else if (arg == "--wake")
+            valid = parseWakePolicy(text, options.wake);
+        else if (arg == "--schedule")
+            valid = parseSchedule(text, options.schedule);
+        else if (arg == "--stores")
+            valid = parseStoreMode(text, options.stores);
+        else if (arg == "--reduction")
+            valid = parseReduction(text, options.reduction);
+        else
+            valid = false;
+
+        if (!valid)
+        {
+            std::cerr << "Invalid option " << arg << " " << text << "\n";
+            printUsage(argv[0], groups);
+            return false;
+        }
+    }
+
+    if (options.threads == 0)
+        options.threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (options.rows <= 0 || options.cols <= 0 || options.threads <= 0 || options.reps <= 0 ||
+        options.warmups < 0 || options.streamMb < 0 || options.chunkMb <= 0)
+    {
+        std::cerr << "Rows, columns, threads and reps must be positive\n";
+        return false;
+    }
+    return true;
+}
+
+// Pins `pool` according to --pin / --cpus and returns the policy name to record
+// with its results ("none" when unpinned or when pinning failed).
+inline std::string applyPinning(ThreadPool &pool, const Options &options)
+{
+    if (options.pin == PinPolicy::None)
+        return pinPolicyName(PinPolicy::None);
+    if (pinPool(pool, pinAssignment(options.pin, pool.size(), options.cpuList)))
+        return pinPolicyName(options.pin);
+    std::cerr << "Cannot pin " << pool.size() << " threads with policy " << pinPolicyName(options.pin)
+              << "; results are recorded as unpinned\n";
+    return pinPolicyName(PinPolicy::None);
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// Page size the huge-page paths ask for (x86-64 and arm64 default).
+constexpr std::size_t HUGE_PAGE_SIZE = std::size_t(2) << 20;
+
+// What a Matrix asks the allocator for.
+//   Heap  - std::aligned_alloc, whatever the C library and THP setting give.
+//   Huge  - explicit MAP_HUGETLB pages from the reserved pool, falling back to
+//           madvise(MADV_HUGEPAGE) on transparent huge pages, then to Small.
+//   Small - mmap with MADV_NOHUGEPAGE: guaranteed 4 KB pages, the baseline for
+//           measuring what huge pages buy.
+enum class PagePolicy
+{
+    Heap,
+    Huge,
+    Small
+};
+
+constexpr PagePolicy ALL_PAGE_POLICIES[] = {PagePolicy::Heap, PagePolicy::Huge, PagePolicy::Small};
+
+inline const char *pagePolicyName(PagePolicy policy)
+{
+    switch (policy)
+    {
+    case PagePolicy::Heap:  return "heap";
+    case PagePolicy::Huge:  return "huge";
+    case PagePolicy::Small: return "small";
+    }
+    return "unknown";
+}
+
+inline bool parsePagePolicy(const std::string &text, PagePolicy &policy)
+{
+    for (PagePolicy candidate : ALL_PAGE_POLICIES)
+        if (text == pagePolicyName(candidate))
+        {
+            policy = candidate;
+            return true;
+        }
+    return false;
+}
+
+// What the allocator actually obtained.
+enum class PageBacking
+{
+    Heap,     // aligned_alloc
+    HugeTlb,  // MAP_HUGETLB, 2 MB pages guaranteed
+    Thp,      // MADV_HUGEPAGE: kernel may back it with 2 MB pages on first touch
+    Small,    // plain 4 KB mmap pages
+    Shared    // MAP_SHARED mapping of a POSIX shared-memory object (processes.h)
+};
+
+inline const char *pageBackingName(PageBacking backing)
+{
+    switch (backing)
+    {
+    case PageBacking::Heap:    return "heap";
+    case PageBacking::HugeTlb: return "hugetlb";
+    case PageBacking::Thp:     return "thp";
+    case PageBacking::Small:   return "4k";
+    case PageBacking::Shared:  return "shm";
+    }
+    return "unknown";
+}
+
+struct PageAllocation
+{
+    void *data = nullptr;
+    std::size_t bytes = 0; // length to release (mapped length for mmap backings)
+    PageBacking backing = PageBacking::Heap;
+};
+
+#ifdef __linux__
+// mmap of `bytes` aligned to HUGE_PAGE_SIZE (over-map, then trim both ends) so
+// THP can use huge pages from the first byte.
+inline void *mapAligned(std::size_t bytes)
+{
+    const std::size_t span = bytes + HUGE_PAGE_SIZE;
+    void *raw = ::mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return nullptr;
+    const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw);
+    const std::uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    if (aligned > start)
+        ::munmap(raw, aligned - start);
+    if (start + span > aligned + bytes)
+        ::munmap(reinterpret_cast<void *>(aligned + bytes), start + span - aligned - bytes);
+    return reinterpret_cast<void *>(aligned);
+}
+#endif
+
+// Allocates at least `bytes` (cache-line aligned) according to `policy`.
+// Throws std::bad_alloc when even the last fallback fails.
+inline PageAllocation allocatePages(std::size_t bytes, PagePolicy policy)
+{
+    PageAllocation allocation;
+    bytes = (bytes + 63) / 64 * 64;
+#ifdef __linux__
+    if (policy != PagePolicy::Heap)
+    {
+        const std::size_t rounded = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        if (policy == PagePolicy::Huge)
+        {
+            void *p = ::mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                             -1, 0);
+            if (p != MAP_FAILED)
+                return {p, rounded, PageBacking::HugeTlb};
+        }
+        if (void *p = mapAligned(rounded))
+        {
+            const bool huge = policy == PagePolicy::Huge && ::madvise(p, rounded, MADV_HUGEPAGE) == 0;
+            if (!huge)
+                ::madvise(p, rounded, MADV_NOHUGEPAGE);
+            return {p, rounded, huge ? PageBacking::Thp : PageBacking::Small};
+        }
+        throw std::bad_alloc();
+    }
+#else
+    (void)policy;
+#endif
+    allocation.data = std::aligned_alloc(64, bytes);
+    if (!allocation.data)
+        throw std::bad_alloc();
+    allocation.bytes = bytes;
+    return allocation;
+}
+
+inline void freePages(const PageAllocation &allocation)
+{
+    if (!allocation.data)
+        return;
+#ifdef __linux__
+    if (allocation.backing != PageBacking::Heap)
+    {
+        ::munmap(allocation.data, allocation.bytes);
+        return;
+    }
+#endif
+    std::free(allocation.data);
+}
+
+// Bytes of [data, data + bytes) currently backed by huge pages (hugetlb or
+// THP), from /proc/self/smaps; -1 when smaps cannot be read. Only meaningful
+// after the memory has been touched.
+inline long long hugePageBytes(const void *data, std::size_t bytes)
+{
+#ifdef __linux__
+    std::FILE *smaps = std::fopen("/proc/self/smaps", "r");
+    if (!smaps)
+        return -1;
+    const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(data), last = first + bytes;
+    long long total = 0;
+    bool inside = false;
+    std::size_t pageKb = 4;
+    char line[256];
+    while (std::fgets(line, sizeof(line), smaps))
+    {
+        unsigned long start = 0, end = 0;
+        long long kb = 0;
+        if (std::sscanf(line, "%lx-%lx ", &start, &end) == 2 && std::strchr(line, '-') < std::strchr(line, ' '))
+        {
+            inside = start < last && end > first;
+            pageKb = 4;
+        }
+        else if (inside && std::sscanf(line, "KernelPageSize: %lld kB", &kb) == 1)
+            pageKb = static_cast<std::size_t>(kb);
+        else if (inside && std::sscanf(line, "AnonHugePages: %lld kB", &kb) == 1)
+            total += kb * 1024;
+        else if (inside && pageKb > 4 && std::sscanf(line, "Rss: %lld kB", &kb) == 1)
+            total += kb * 1024; // hugetlb mappings report Rss in their own page size
+    }
+    std::fclose(smaps);
+    return total;
+#else
+    (void)data;
+    (void)bytes;
+    return -1;
+#endif
+}
+
+// "thp, 98% in huge pages" style summary of a touched allocation for reports.
+inline std::string describeBacking(PageBacking backing, const void *data, std::size_t bytes)
+{
+    std::string text = pageBackingName(backing);
+    const long long huge = bytes ? hugePageBytes(data, bytes) : -1;
+    if (huge >= 0)
+        text += ", " + std::to_string(static_cast<int>(100.0 * std::min<double>(huge, bytes) / bytes)) +
+                "% in huge pages";
+    return text;
+}
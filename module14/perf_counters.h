@@ -0,0 +1,298 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "thread_pool.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware events sampled per worker thread by PoolCounters.
+enum class Counter
+{
+    Cycles,
+    Instructions,
+    LlcMisses,
+    DtlbMisses,
+    StalledBackend
+};
+
+constexpr int COUNTER_COUNT = 5;
+constexpr Counter ALL_COUNTERS[COUNTER_COUNT] = {Counter::Cycles, Counter::Instructions, Counter::LlcMisses,
+                                                 Counter::DtlbMisses, Counter::StalledBackend};
+
+inline const char *counterName(Counter counter)
+{
+    switch (counter)
+    {
+    case Counter::Cycles:         return "cycles";
+    case Counter::Instructions:   return "instructions";
+    case Counter::LlcMisses:      return "llc-misses";
+    case Counter::DtlbMisses:     return "dtlb-misses";
+    case Counter::StalledBackend: return "stalled-backend";
+    }
+    return "unknown";
+}
+
+// Accumulated counts of one thread. A counter the kernel refused to open, or
+// never scheduled on a PMU, stays invalid and prints as n/a.
+struct CounterValues
+{
+    double value[COUNTER_COUNT] = {};
+    bool valid[COUNTER_COUNT] = {};
+
+    double operator[](Counter counter) const { return value[static_cast<int>(counter)]; }
+    bool has(Counter counter) const { return valid[static_cast<int>(counter)]; }
+};
+
+// perf_event_open counters for every worker of a pool. Each worker opens its
+// own events once (a per-thread, user-space-only count); start() and stop()
+// then enable and read them from the calling thread with ioctl/read, so no
+// work is dispatched to the pool around a kernel call. Multiplexed counters
+// are scaled by time enabled / time running. When the kernel allows no
+// counters at all (no PMU in a VM, perf_event_paranoid, seccomp), or when
+// constructed disabled, available() is false, start()/stop() do nothing and
+// error() says why.
+class PoolCounters
+{
+public:
+    explicit PoolCounters(ThreadPool &pool, bool enabled = true)
+        : fds_(pool.size() * COUNTER_COUNT, -1), totals_(pool.size()), calls_(0)
+    {
+        if (!enabled)
+        {
+            error_ = "disabled";
+            return;
+        }
+#ifdef __linux__
+        std::vector<int> errors(pool.size() * COUNTER_COUNT, 0);
+        pool.run([&](int worker)
+                 {
+                     for (int c = 0; c < COUNTER_COUNT; c++)
+                     {
+                         int &fd = fds_[worker * COUNTER_COUNT + c];
+                         fd = openCounter(ALL_COUNTERS[c]);
+                         errors[worker * COUNTER_COUNT + c] = fd < 0 ? errno : 0;
+                     }
+                 });
+        for (std::size_t i = 0; i < fds_.size(); i++)
+            if (fds_[i] >= 0)
+                available_ = true;
+            else if (error_.empty())
+                error_ = std::string(counterName(ALL_COUNTERS[i % COUNTER_COUNT])) + ": " + std::strerror(errors[i]);
+        if (!available_)
+            error_ += " (perf_event_paranoid=" + paranoidLevel() + ")";
+#else
+        (void)pool;
+        error_ = "perf_event_open is Linux-only";
+#endif
+    }
+
+    PoolCounters(const PoolCounters &) = delete;
+    PoolCounters &operator=(const PoolCounters &) = delete;
+
+    ~PoolCounters()
+    {
+#ifdef __linux__
+        for (int fd : fds_)
+            if (fd >= 0)
+                ::close(fd);
+#endif
+    }
+
+    bool available() const { return available_; }
+    // First counter that failed to open, empty when all did.
+    const std::string &error() const { return error_; }
+    int workers() const { return static_cast<int>(totals_.size()); }
+    // Number of start()/stop() pairs accumulated into totals.
+    int calls() const { return calls_; }
+
+    void start()
+    {
+        if (!available_)
+            return;
+#ifdef __linux__
+        for (int fd : fds_)
+            if (fd >= 0)
+            {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+    }
+
+    // Disables the counters and adds this interval to each worker's totals.
+    void stop()
+    {
+        if (!available_)
+            return;
+#ifdef __linux__
+        for (int fd : fds_)
+            if (fd >= 0)
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        for (std::size_t i = 0; i < fds_.size(); i++)
+        {
+            std::uint64_t data[3]; // value, time enabled, time running
+            if (fds_[i] < 0 || ::read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) ||
+                data[2] == 0)
+                continue;
+            CounterValues &total = totals_[i / COUNTER_COUNT];
+            const int c = static_cast<int>(i % COUNTER_COUNT);
+            total.value[c] += static_cast<double>(data[0]) * data[1] / data[2];
+            total.valid[c] = true;
+        }
+#endif
+        calls_++;
+    }
+
+    void reset()
+    {
+        for (CounterValues &total : totals_)
+            total = CounterValues{};
+        calls_ = 0;
+    }
+
+    const CounterValues &worker(int worker) const { return totals_[worker]; }
+
+    // Sum over workers; a counter is valid if any worker produced it.
+    CounterValues total() const
+    {
+        CounterValues sum;
+        for (const CounterValues &values : totals_)
+            for (int c = 0; c < COUNTER_COUNT; c++)
+                if (values.valid[c])
+                {
+                    sum.value[c] += values.value[c];
+                    sum.valid[c] = true;
+                }
+        return sum;
+    }
+
+private:
+#ifdef __linux__
+    static int openCounter(Counter counter)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        const std::uint64_t readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        switch (counter)
+        {
+        case Counter::Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case Counter::Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case Counter::LlcMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | readMiss;
+            break;
+        case Counter::DtlbMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | readMiss;
+            break;
+        case Counter::StalledBackend:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_STALLED_CYCLES_BACKEND;
+            break;
+        }
+        // pid 0, cpu -1: this thread, on whichever CPU it runs.
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    static std::string paranoidLevel()
+    {
+        std::ifstream file("/proc/sys/kernel/perf_event_paranoid");
+        std::string level;
+        return file >> level ? level : "unknown";
+    }
+#endif
+
+    std::vector<int> fds_;
+    std::vector<CounterValues> totals_;
+    int calls_;
+    bool available_ = false;
+    std::string error_;
+};
+
+// Totals per call as (name, value) pairs for BenchRecord tags; empty when no
+// counters are available.
+inline std::vector<std::pair<std::string, std::string>> counterTags(const PoolCounters &counters)
+{
+    std::vector<std::pair<std::string, std::string>> tags;
+    if (!counters.available() || counters.calls() == 0)
+        return tags;
+    const CounterValues total = counters.total();
+    for (Counter counter : ALL_COUNTERS)
+        if (total.has(counter))
+            tags.emplace_back(counterName(counter), std::to_string(static_cast<long long>(total[counter] / counters.calls())));
+    if (total.has(Counter::Cycles) && total.has(Counter::Instructions) && total[Counter::Cycles] > 0)
+        tags.emplace_back("ipc", std::to_string(total[Counter::Instructions] / total[Counter::Cycles]));
+    return tags;
+}
+
+// Per-worker table of counts per call, with IPC and backend-stall share.
+inline void printCounters(std::ostream &out, const PoolCounters &counters)
+{
+    if (!counters.available())
+    {
+        out << "Counters:     unavailable (" << counters.error() << ")\n";
+        return;
+    }
+
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    const double calls = counters.calls() > 0 ? counters.calls() : 1;
+    out << "Counters per call:\n" << std::setw(8) << "worker";
+    for (Counter counter : ALL_COUNTERS)
+        out << std::setw(17) << counterName(counter);
+    out << std::setw(7) << "IPC" << std::setw(9) << "stall%\n";
+
+    auto row = [&](const std::string &label, const CounterValues &values)
+    {
+        out << std::setw(8) << label << std::fixed << std::setprecision(0);
+        for (Counter counter : ALL_COUNTERS)
+        {
+            if (values.has(counter))
+                out << std::setw(17) << values[counter] / calls;
+            else
+                out << std::setw(17) << "n/a";
+        }
+        out << std::setprecision(2);
+        const bool haveCycles = values.has(Counter::Cycles) && values[Counter::Cycles] > 0;
+        if (haveCycles && values.has(Counter::Instructions))
+            out << std::setw(7) << values[Counter::Instructions] / values[Counter::Cycles];
+        else
+            out << std::setw(7) << "n/a";
+        if (haveCycles && values.has(Counter::StalledBackend))
+            out << std::setw(8) << 100 * values[Counter::StalledBackend] / values[Counter::Cycles] << "%";
+        else
+            out << std::setw(9) << "n/a";
+        out << "\n";
+    };
+    for (int worker = 0; worker < counters.workers(); worker++)
+        row(std::to_string(worker), counters.worker(worker));
+    row("total", counters.total());
+    out.flags(flags);
+    out.precision(precision);
+    if (!counters.error().empty())
+        out << "              (" << counters.error() << ")\n";
+}
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <vector>
+#include "matrix_add.h"
+#include "timing.h"
+
+// Load / compute / store pipeline for a stream of matrix pairs. Three stages
+// run at once, linked by bounded queues:
+//   reader  (own thread)   fills a free frame's operands      -> loaded
+//   compute (caller, pool) result = left + right               -> computed
+//   writer  (own thread)   stores the result, frees the frame  -> free
+// While pair i is being added, pair i + 1 is loading and pair i - 1 is being
+// stored. A stage that gets ahead blocks on a full queue (backpressure), so at
+// most 2 * depth + 3 frames are ever in flight and memory stays bounded
+// whatever the rates of the source and sink.
+
+// Default capacity of the loaded and computed queues: double buffering.
+constexpr std::size_t DEFAULT_PIPELINE_DEPTH = 2;
+
+// FIFO of at most `capacity` items shared by one producer and one consumer
+// stage. close() ends the stream: push fails from then on and pop fails once
+// the queue has drained. The time-weighted mean depth shows where the frames
+// pile up, i.e. which stage downstream is the bottleneck.
+template <typename Item>
+class BoundedQueue
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit BoundedQueue(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+    // Blocks while the queue is full. Returns false, dropping `item`, if the
+    // queue was closed.
+    bool push(Item item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [&] { return closed_ || items_.size() < capacity_; });
+        if (closed_)
+            return false;
+        account();
+        items_.push_back(std::move(item));
+        lock.unlock();
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    // Blocks while the queue is empty and open. Returns false at end of stream.
+    bool pop(Item &item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [&] { return closed_ || !items_.empty(); });
+        if (items_.empty())
+            return false;
+        account();
+        item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+    }
+
+    std::size_t capacity() const { return capacity_; }
+
+    // Mean number of queued items over the queue's lifetime so far.
+    double meanDepth()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        account();
+        const double lifetime = std::chrono::duration<double, std::nano>(last_ - created_).count();
+        return lifetime > 0 ? depthNs_ / lifetime : 0;
+    }
+
+private:
+    // Adds the time since the last change, weighted by the current depth.
+    void account()
+    {
+        const Clock::time_point now = Clock::now();
+        depthNs_ += items_.size() * std::chrono::duration<double, std::nano>(now - last_).count();
+        last_ = now;
+    }
+
+    std::mutex mutex_;
+    std::condition_variable notFull_, notEmpty_;
+    std::deque<Item> items_;
+    std::size_t capacity_;
+    bool closed_ = false;
+    Clock::time_point created_ = Clock::now();
+    Clock::time_point last_ = created_;
+    double depthNs_ = 0;
+};
+
+// One matrix pair in flight and its result.
+template <typename T>
+struct PipelineFrame
+{
+    std::size_t sequence = 0;
+    Matrix<T> left, right, result;
+    AccumulatorOf<T> sum = 0;
+    std::chrono::steady_clock::time_point start; // when the reader began loading it
+};
+
+// Where one stage's wall time went: running its own work, waiting for input
+// (starved) and waiting for room downstream (blocked by backpressure).
+struct StageStats
+{
+    std::size_t items = 0;
+    double busyNs = 0;
+    double starvedNs = 0;
+    double blockedNs = 0;
+};
+
+struct PipelineStats
+{
+    StageStats read, compute, write;
+    double loadedDepth = 0;   // mean depth of the reader -> compute queue
+    double computedDepth = 0; // mean depth of the compute -> writer queue
+    std::size_t depth = 0;    // capacity of both
+    std::vector<double> latencyNs; // per frame, load start to store done, in stream order
+    double wallNs = 0;
+    double sum = 0;
+
+    std::size_t frames() const { return latencyNs.size(); }
+    // Fraction of the wall time `stage` spent working.
+    double occupancy(const StageStats &stage) const { return wallNs > 0 ? stage.busyNs / wallNs : 0; }
+
+    // Nearest-rank percentile of the end-to-end latency, q in (0, 1].
+    double latencyPercentile(double q) const
+    {
+        if (latencyNs.empty())
+            return 0;
+        std::vector<double> sorted = latencyNs;
+        std::sort(sorted.begin(), sorted.end());
+        const std::size_t rank = static_cast<std::size_t>(std::ceil(q * sorted.size()));
+        return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+    }
+};
+
+// Adds every pair of the stream `load` produces and hands each result to
+// `store`, overlapping the three stages as described above.
+//   load(frame)  fills frame.left and frame.right (rows x cols); false ends
+//                the stream. Runs on the reader thread.
+//   store(frame) consumes frame.result and frame.sum. Runs on the writer thread.
+// The add itself runs on `pool` from the calling thread, so load and store
+// must not use `pool`. An exception from any stage stops the others and is
+// rethrown here.
+template <typename T, typename Load, typename Store>
+PipelineStats runPipeline(ThreadPool &pool, std::size_t rows, std::size_t cols, Load load, Store store,
+                          std::size_t depth = DEFAULT_PIPELINE_DEPTH, Schedule schedule = Schedule::WorkStealing)
+{
+    using Clock = std::chrono::steady_clock;
+    depth = std::max<std::size_t>(depth, 1);
+    // One frame in each stage plus full queues: the reader never waits for
+    // a free frame unless the queues themselves are full.
+    std::vector<PipelineFrame<T>> frames(2 * depth + 3);
+    BoundedQueue<std::size_t> free(frames.size()), loaded(depth), computed(depth);
+    for (std::size_t slot = 0; slot < frames.size(); slot++)
+    {
+        frames[slot].left = Matrix<T>(rows, cols);
+        frames[slot].right = Matrix<T>(rows, cols);
+        frames[slot].result = Matrix<T>(rows, cols);
+        free.push(slot);
+    }
+    auto closeAll = [&]
+    {
+        free.close();
+        loaded.close();
+        computed.close();
+    };
+
+    PipelineStats stats;
+    stats.depth = depth;
+    const Clock::time_point begin = Clock::now();
+
+    std::future<void> reader = std::async(std::launch::async, [&]
+    {
+        try
+        {
+            std::size_t slot = 0;
+            for (std::size_t sequence = 0;; sequence++)
+            {
+                bool ok = false;
+                stats.read.blockedNs += timeNanos([&] { ok = free.pop(slot); });
+                if (!ok)
+                    break;
+                PipelineFrame<T> &frame = frames[slot];
+                frame.sequence = sequence;
+                frame.start = Clock::now();
+                stats.read.busyNs += timeNanos([&] { ok = load(frame); });
+                if (!ok)
+                    break;
+                stats.read.items++;
+                stats.read.blockedNs += timeNanos([&] { ok = loaded.push(slot); });
+                if (!ok)
+                    break;
+            }
+            loaded.close();
+        }
+        catch (...)
+        {
+            closeAll();
+            throw;
+        }
+    });
+
+    std::future<void> writer = std::async(std::launch::async, [&]
+    {
+        try
+        {
+            std::size_t slot = 0;
+            for (;;)
+            {
+                bool ok = false;
+                stats.write.starvedNs += timeNanos([&] { ok = computed.pop(slot); });
+                if (!ok)
+                    break;
+                const PipelineFrame<T> &frame = frames[slot];
+                stats.write.busyNs += timeNanos([&] { store(frame); });
+                stats.write.items++;
+                stats.latencyNs.push_back(std::chrono::duration<double, std::nano>(Clock::now() - frame.start).count());
+                stats.sum += frame.sum;
+                free.push(slot);
+            }
+        }
+        catch (...)
+        {
+            closeAll();
+            throw;
+        }
+    });
+
+    try
+    {
+        std::size_t slot = 0;
+        for (;;)
+        {
+            bool ok = false;
+            stats.compute.starvedNs += timeNanos([&] { ok = loaded.pop(slot); });
+            if (!ok)
+                break;
+            PipelineFrame<T> &frame = frames[slot];
+            stats.compute.busyNs +=
+                timeNanos([&] { frame.sum = matrixAdd(pool, frame.left, frame.right, frame.result, schedule); });
+            stats.compute.items++;
+            stats.compute.blockedNs += timeNanos([&] { ok = computed.push(slot); });
+            if (!ok)
+                break;
+        }
+        computed.close();
+    }
+    catch (...)
+    {
+        closeAll();
+        reader.wait();
+        writer.wait();
+        throw;
+    }
+    reader.get();
+    writer.get();
+    stats.wallNs = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+    stats.loadedDepth = loaded.meanDepth();
+    stats.computedDepth = computed.meanDepth();
+    return stats;
+}
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "matrix.h"
+#include "matrix_add.h"
+#include "scheduler.h"
+#include "simd_kernels.h"
+
+// Multi-process matrix add, a single-machine stand-in for scale-out across
+// nodes. The coordinator places the operands in POSIX shared-memory objects
+// and forks worker processes, which attach to them by name. Work travels over
+// one Unix socket per worker:
+//   coordinator -> worker: TileBatch header, then `count` Tile records
+//                          (count 0 tells the worker to exit)
+//   worker -> coordinator: one ready byte after attaching, then one
+//                          AccumulatorOf<T> partial sum per batch
+// Only tile coordinates and sums cross the process boundary; the matrices
+// themselves never do.
+
+struct TileBatch
+{
+    std::uint32_t count;
+};
+
+[[noreturn]] inline void failSystem(const std::string &what)
+{
+    throw std::runtime_error(what + " failed: " + std::strerror(errno));
+}
+
+// Writes or reads exactly `bytes` on a socket, resuming after short transfers
+// and EINTR. Returns false if the peer has gone (EOF, EPIPE, ECONNRESET).
+inline bool sendAll(int fd, const void *buffer, std::size_t bytes)
+{
+    const char *p = static_cast<const char *>(buffer);
+    while (bytes > 0)
+    {
+        const ssize_t done = ::send(fd, p, bytes, MSG_NOSIGNAL);
+        if (done < 0 && errno == EINTR)
+            continue;
+        if (done < 0 && (errno == EPIPE || errno == ECONNRESET))
+            return false;
+        if (done < 0)
+            failSystem("send");
+        p += done;
+        bytes -= static_cast<std::size_t>(done);
+    }
+    return true;
+}
+
+inline bool receiveAll(int fd, void *buffer, std::size_t bytes)
+{
+    char *p = static_cast<char *>(buffer);
+    while (bytes > 0)
+    {
+        const ssize_t done = ::recv(fd, p, bytes, 0);
+        if (done < 0 && errno == EINTR)
+            continue;
+        if (done == 0 || (done < 0 && errno == ECONNRESET))
+            return false;
+        if (done < 0)
+            failSystem("recv");
+        p += done;
+        bytes -= static_cast<std::size_t>(done);
+    }
+    return true;
+}
+
+// Maps the shared-memory object `name` read-write. With `create` the object
+// must not exist yet and is sized to `bytes`; otherwise an existing object is
+// attached.
+inline PageAllocation mapShared(const std::string &name, std::size_t bytes, bool create)
+{
+    const int fd = ::shm_open(name.c_str(), create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR, 0600);
+    if (fd < 0)
+        failSystem("shm_open " + name);
+    if (create && ::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+    {
+        const int error = errno;
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        errno = error;
+        failSystem("ftruncate " + name);
+    }
+    void *data = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        if (create)
+            ::shm_unlink(name.c_str());
+        errno = error;
+        failSystem("mmap " + name);
+    }
+    return {data, bytes, PageBacking::Shared};
+}
+
+// Row-major matrix stored in the shared-memory object `name`, with the same
+// padded stride as an ordinary Matrix so every process computes the same
+// layout from the shape alone.
+template <typename T>
+Matrix<T> sharedMatrix(const std::string &name, std::size_t rows, std::size_t cols, bool create)
+{
+    const std::size_t stride = Matrix<T>::paddedStride(cols);
+    return Matrix<T>(rows, cols, stride, mapShared(name, rows * stride * sizeof(T), create));
+}
+
+// Coordinator side of the multi-process add. The constructor creates the three
+// shared matrices and forks `workers` processes; add() hands the tiles out
+// over the sockets and sums the partials. Construct it before starting any
+// threads: fork() copies only the calling thread, so a lock held by another
+// thread would stay locked forever in the children.
+template <typename T>
+class ProcessGroup
+{
+public:
+    ProcessGroup(int workers, std::size_t rows, std::size_t cols)
+    {
+        static int groups = 0;
+        const std::string prefix = "/module14-" + std::to_string(::getpid()) + "-" + std::to_string(groups++) + "-";
+        for (const char *operand : {"left", "right", "result"})
+            names_.push_back(prefix + operand);
+        tiles_ = makeTiles(static_cast<int>(rows), static_cast<int>(cols),
+                           defaultTileShape(static_cast<int>(cols), sizeof(T)));
+
+        try
+        {
+            left_ = sharedMatrix<T>(names_[0], rows, cols, true);
+            right_ = sharedMatrix<T>(names_[1], rows, cols, true);
+            result_ = sharedMatrix<T>(names_[2], rows, cols, true);
+            for (int w = 0; w < std::max(workers, 1); w++)
+                spawn(rows, cols);
+            // Every worker has mapped the objects; their names are no longer
+            // needed, and unlinking now means nothing leaks if a process dies.
+            for (int socket : sockets_)
+            {
+                char ready = 0;
+                if (!receiveAll(socket, &ready, 1))
+                    throw std::runtime_error("ProcessGroup: a worker exited before attaching");
+            }
+            unlinkNames();
+        }
+        catch (...)
+        {
+            shutdown();
+            throw;
+        }
+    }
+
+    ~ProcessGroup() { shutdown(); }
+
+    ProcessGroup(const ProcessGroup &) = delete;
+    ProcessGroup &operator=(const ProcessGroup &) = delete;
+
+    Matrix<T> &left() { return left_; }
+    Matrix<T> &right() { return right_; }
+    Matrix<T> &result() { return result_; }
+    int workers() const { return static_cast<int>(sockets_.size()); }
+    const std::vector<Tile> &tiles() const { return tiles_; }
+    // Batches sent by the last add().
+    int messages() const { return messages_; }
+
+    // result = left + right across the workers; returns the sum of the result.
+    // `chunk` tiles go out per message and an idle worker gets the next batch,
+    // like the pool's dynamic schedule; chunk <= 0 sends each worker one
+    // contiguous block up front, like the static schedule.
+    AccumulatorOf<T> add(int chunk = 0)
+    {
+        const std::size_t count = tiles_.size();
+        const std::size_t perBatch =
+            chunk > 0 ? static_cast<std::size_t>(chunk) : (count + sockets_.size() - 1) / sockets_.size();
+        std::size_t next = 0;
+        int busy = 0;
+        messages_ = 0;
+        auto assign = [&](int socket)
+        {
+            if (next >= count)
+                return;
+            const TileBatch batch{static_cast<std::uint32_t>(std::min(perBatch, count - next))};
+            if (!sendAll(socket, &batch, sizeof(batch)) ||
+                !sendAll(socket, &tiles_[next], batch.count * sizeof(Tile)))
+                throw std::runtime_error("ProcessGroup: lost a worker");
+            next += batch.count;
+            busy++;
+            messages_++;
+        };
+        for (int socket : sockets_)
+            assign(socket);
+
+        std::vector<pollfd> polls;
+        for (int socket : sockets_)
+            polls.push_back(pollfd{socket, POLLIN, 0});
+        AccumulatorOf<T> total = 0;
+        while (busy > 0)
+        {
+            if (::poll(polls.data(), polls.size(), -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                failSystem("poll");
+            }
+            for (pollfd &entry : polls)
+            {
+                if (!entry.revents)
+                    continue;
+                AccumulatorOf<T> partial;
+                if (!receiveAll(entry.fd, &partial, sizeof(partial)))
+                    throw std::runtime_error("ProcessGroup: lost a worker");
+                total += partial;
+                busy--;
+                assign(entry.fd);
+            }
+        }
+        return total;
+    }
+
+private:
+    void spawn(std::size_t rows, std::size_t cols)
+    {
+        int pair[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+            failSystem("socketpair");
+        const pid_t pid = ::fork();
+        if (pid < 0)
+        {
+            ::close(pair[0]);
+            ::close(pair[1]);
+            failSystem("fork");
+        }
+        if (pid == 0)
+        {
+            ::close(pair[0]);
+            for (int socket : sockets_)
+                ::close(socket);
+            // _exit: the child must not run the parent's destructors or
+            // flush its copy of the parent's stdio buffers.
+            int status = 1;
+            try
+            {
+                status = workerMain(pair[1], rows, cols);
+            }
+            catch (...)
+            {
+            }
+            ::_exit(status);
+        }
+        ::close(pair[1]);
+        sockets_.push_back(pair[0]);
+        pids_.push_back(pid);
+    }
+
+    // Worker process: attaches to the operands, reports ready, then adds each
+    // batch of tiles and replies with its sum until told to stop.
+    int workerMain(int socket, std::size_t rows, std::size_t cols)
+    {
+        Matrix<T> left = sharedMatrix<T>(names_[0], rows, cols, false);
+        Matrix<T> right = sharedMatrix<T>(names_[1], rows, cols, false);
+        Matrix<T> result = sharedMatrix<T>(names_[2], rows, cols, false);
+        const AddKernelOf<T> kernel = activeAddKernel<T>();
+        const char ready = 1;
+        if (!sendAll(socket, &ready, 1))
+            return 1;
+
+        std::vector<Tile> tiles;
+        TileBatch batch;
+        while (receiveAll(socket, &batch, sizeof(batch)) && batch.count > 0)
+        {
+            tiles.resize(batch.count);
+            if (!receiveAll(socket, tiles.data(), batch.count * sizeof(Tile)))
+                return 1;
+            AccumulatorOf<T> sum = 0;
+            for (const Tile &tile : tiles)
+                sum += matrixAddTile(left, right, result, tile, kernel);
+            if (!sendAll(socket, &sum, sizeof(sum)))
+                return 1;
+        }
+        return 0;
+    }
+
+    // Removes the objects that were created; mappings stay valid.
+    void unlinkNames()
+    {
+        if (names_.empty())
+            return;
+        if (left_.data())
+            ::shm_unlink(names_[0].c_str());
+        if (right_.data())
+            ::shm_unlink(names_[1].c_str());
+        if (result_.data())
+            ::shm_unlink(names_[2].c_str());
+        names_.clear();
+    }
+
+    // Tells every worker to exit, closes the sockets and reaps the processes.
+    void shutdown()
+    {
+        const TileBatch stop{0};
+        for (int socket : sockets_)
+        {
+            // A worker that already died just closes its end.
+            ::send(socket, &stop, sizeof(stop), MSG_NOSIGNAL);
+            ::close(socket);
+        }
+        for (pid_t pid : pids_)
+            while (::waitpid(pid, nullptr, 0) < 0 && errno == EINTR)
+            {
+            }
+        sockets_.clear();
+        pids_.clear();
+        unlinkNames();
+    }
+
+    std::vector<std::string> names_;
+    Matrix<T> left_, right_, result_;
+    std::vector<Tile> tiles_;
+    std::vector<int> sockets_;
+    std::vector<pid_t> pids_;
+    int messages_ = 0;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// How the threaded matrixAdd combines partial sums.
+//   Fast         - each worker accumulates the tiles it happens to run; the
+//                  floating-point rounding then depends on the thread count and,
+//                  under dynamic or work-stealing schedules, on timing.
+//   Reproducible - one partial per tile, in a slot fixed by the tile's index,
+//                  combined by a pairwise tree whose shape depends only on the
+//                  tile count. Tiles depend only on the matrix shape, so the sum
+//                  is bit-identical for any thread count and schedule.
+enum class Reduction
+{
+    Fast,
+    Reproducible
+};
+
+constexpr Reduction ALL_REDUCTIONS[] = {Reduction::Fast, Reduction::Reproducible};
+
+inline const char *reductionName(Reduction reduction)
+{
+    switch (reduction)
+    {
+    case Reduction::Fast:         return "fast";
+    case Reduction::Reproducible: return "reproducible";
+    }
+    return "unknown";
+}
+
+inline bool parseReduction(const std::string &text, Reduction &reduction)
+{
+    for (Reduction candidate : ALL_REDUCTIONS)
+        if (text == reductionName(candidate))
+        {
+            reduction = candidate;
+            return true;
+        }
+    return false;
+}
+
+// Sums `values` with a fixed binary tree: neighbours at distance 1, then 2, 4,
+// ... are added in place, so the association order depends only on the count.
+// Rounding error also grows with log2(count) rather than count. Overwrites
+// `values`.
+template <typename T>
+T pairwiseSum(std::vector<T> &values)
+{
+    const std::size_t count = values.size();
+    for (std::size_t width = 1; width < count; width *= 2)
+        for (std::size_t i = 0; i + width < count; i += 2 * width)
+            values[i] += values[i + width];
+    return count ? values[0] : T(0);
+}
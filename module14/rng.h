@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "matrix.h"
+#include "scheduler.h"
+#include "thread_pool.h"
+
+// Default seed for module14 matrix data.
+constexpr std::uint64_t DEFAULT_SEED = 14;
+// Values are drawn from [0, DEFAULT_VALUE_RANGE), like the original rand() % 100.
+constexpr std::uint32_t DEFAULT_VALUE_RANGE = 100;
+
+// DEFAULT_VALUE_RANGE, shrunk for element types where the sum of two values
+// would not fit (int8 gets [0, 64)), so matrixAdd never wraps on generated data.
+template <typename T>
+constexpr std::uint32_t valueRange()
+{
+    constexpr double limit = static_cast<double>(std::numeric_limits<T>::max()) / 2 + 1;
+    return limit < DEFAULT_VALUE_RANGE ? static_cast<std::uint32_t>(limit) : DEFAULT_VALUE_RANGE;
+}
+// Stream ids of the left and right input matrices.
+constexpr std::uint32_t LEFT_STREAM = 0;
+constexpr std::uint32_t RIGHT_STREAM = 1;
+
+// Philox4x32-10 counter-based generator (Salmon et al., SC'11). Output is a pure
+// function of (key, counter), so any element can be generated independently, in
+// any order, on any thread.
+struct Philox4x32
+{
+    std::uint32_t key0;
+    std::uint32_t key1;
+
+    explicit Philox4x32(std::uint64_t seed)
+        : key0(static_cast<std::uint32_t>(seed)), key1(static_cast<std::uint32_t>(seed >> 32)) {}
+
+    // Encrypts the 128-bit counter {c0, c1, c2, c3} into four 32-bit outputs.
+    void operator()(std::uint32_t c0, std::uint32_t c1, std::uint32_t c2, std::uint32_t c3,
+                    std::uint32_t out[4]) const
+    {
+        std::uint32_t k0 = key0, k1 = key1;
+        for (int round = 0; round < 10; round++)
+        {
+            std::uint64_t p0 = std::uint64_t(0xD2511F53u) * c0;
+            std::uint64_t p1 = std::uint64_t(0xCD9E8D57u) * c2;
+            std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<std::uint32_t>(p1);
+            c3 = static_cast<std::uint32_t>(p0);
+            c0 = n0;
+            c2 = n2;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+    // Same as operator() for BATCH counters {first + i, c1, c2, c3}, i in [0, BATCH).
+    // Rounds run outermost over structure-of-arrays lanes so the compiler can keep
+    // all BATCH blocks in vector registers; out[j * BATCH + i] is word j of block i.
+    static constexpr int BATCH = 8;
+
+    void batch(std::uint32_t first, std::uint32_t c1, std::uint32_t c2, std::uint32_t c3,
+               std::uint32_t out[4 * BATCH]) const
+    {
+#ifdef __SSE2__
+        // Two 4-lane vectors per word. SSE2 has no 32-bit high multiply, so the
+        // even and odd lanes go through separate 32x32->64 multiplies.
+        const __m128i m0 = _mm_set1_epi32(static_cast<int>(0xD2511F53u));
+        const __m128i m1 = _mm_set1_epi32(static_cast<int>(0xCD9E8D57u));
+        __m128i x0[2], x1[2], x2[2], x3[2];
+        for (int v = 0; v < 2; v++)
+        {
+            x0[v] = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(first + 4 * v)), _mm_setr_epi32(0, 1, 2, 3));
+            x1[v] = _mm_set1_epi32(static_cast<int>(c1));
+            x2[v] = _mm_set1_epi32(static_cast<int>(c2));
+            x3[v] = _mm_set1_epi32(static_cast<int>(c3));
+        }
+        std::uint32_t k0 = key0, k1 = key1;
+        for (int round = 0; round < 10; round++)
+        {
+            const __m128i vk0 = _mm_set1_epi32(static_cast<int>(k0));
+            const __m128i vk1 = _mm_set1_epi32(static_cast<int>(k1));
+            for (int v = 0; v < 2; v++)
+            {
+                __m128i hi0, lo0, hi1, lo1;
+                mulhilo(x0[v], m0, hi0, lo0);
+                mulhilo(x2[v], m1, hi1, lo1);
+                x0[v] = _mm_xor_si128(_mm_xor_si128(hi1, x1[v]), vk0);
+                x2[v] = _mm_xor_si128(_mm_xor_si128(hi0, x3[v]), vk1);
+                x1[v] = lo1;
+                x3[v] = lo0;
+            }
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        for (int v = 0; v < 2; v++)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 0 * BATCH + 4 * v), x0[v]);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 1 * BATCH + 4 * v), x1[v]);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * BATCH + 4 * v), x2[v]);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 3 * BATCH + 4 * v), x3[v]);
+        }
+#else
+        std::uint32_t x0[BATCH], x1[BATCH], x2[BATCH], x3[BATCH];
+        for (int i = 0; i < BATCH; i++)
+        {
+            x0[i] = first + i;
+            x1[i] = c1;
+            x2[i] = c2;
+            x3[i] = c3;
+        }
+        std::uint32_t k0 = key0, k1 = key1;
+        for (int round = 0; round < 10; round++)
+        {
+            for (int i = 0; i < BATCH; i++)
+            {
+                std::uint64_t p0 = std::uint64_t(0xD2511F53u) * x0[i];
+                std::uint64_t p1 = std::uint64_t(0xCD9E8D57u) * x2[i];
+                std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ x1[i] ^ k0;
+                std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ x3[i] ^ k1;
+                x1[i] = static_cast<std::uint32_t>(p1);
+                x3[i] = static_cast<std::uint32_t>(p0);
+                x0[i] = n0;
+                x2[i] = n2;
+            }
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        for (int i = 0; i < BATCH; i++)
+        {
+            out[0 * BATCH + i] = x0[i];
+            out[1 * BATCH + i] = x1[i];
+            out[2 * BATCH + i] = x2[i];
+            out[3 * BATCH + i] = x3[i];
+        }
+#endif
+    }
+
+private:
+#ifdef __SSE2__
+    // Full 64-bit products of four 32-bit lanes by m, split into high and low words.
+    static void mulhilo(__m128i x, __m128i m, __m128i &hi, __m128i &lo)
+    {
+        __m128i even = _mm_mul_epu32(x, m);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), m);
+        lo = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+        hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)),
+                                _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
+    }
+#endif
+};
+
+// Maps a uniform 32-bit word onto [0, range) with a multiply-shift (no division).
+// Callers convert the result through int32_t, which has a packed conversion to
+// floating point on every x86 level; range must therefore stay below 2^31.
+inline std::uint32_t scaleToRange(std::uint32_t bits, std::uint32_t range)
+{
+    return static_cast<std::uint32_t>((std::uint64_t(bits) * range) >> 32);
+}
+
+// Columns produced by one Philox4x32::batch call.
+constexpr std::size_t RANDOM_GROUP = 4 * Philox4x32::BATCH;
+
+// Element (row, col) of random matrix `stream`. Columns come in groups of
+// RANDOM_GROUP: column g * RANDOM_GROUP + j * BATCH + i is word j of the block
+// with counter {g * BATCH + i, row, stream, row >> 32}, which is exactly the
+// layout batch() writes, so whole rows are generated with contiguous stores.
+inline std::uint32_t randomElement(const Philox4x32 &rng, std::uint32_t stream, std::size_t row, std::size_t col,
+                                   std::uint32_t range = DEFAULT_VALUE_RANGE)
+{
+    const std::size_t group = col / RANDOM_GROUP, offset = col % RANDOM_GROUP;
+    std::uint32_t out[4];
+    rng(static_cast<std::uint32_t>(group * Philox4x32::BATCH + offset % Philox4x32::BATCH),
+        static_cast<std::uint32_t>(row), stream, static_cast<std::uint32_t>(row >> 32), out);
+    return scaleToRange(out[offset / Philox4x32::BATCH], range);
+}
+
+// Writes elements [colBegin, colEnd) of `row` of random matrix `stream` to out[colBegin..].
+template <typename T>
+void randomRow(const Philox4x32 &rng, std::uint32_t stream, std::size_t row, std::size_t colBegin,
+               std::size_t colEnd, T *out, std::uint32_t range = DEFAULT_VALUE_RANGE)
+{
+    for (std::size_t base = colBegin / RANDOM_GROUP * RANDOM_GROUP; base < colEnd; base += RANDOM_GROUP)
+    {
+        std::uint32_t bits[RANDOM_GROUP];
+        rng.batch(static_cast<std::uint32_t>(base / RANDOM_GROUP * Philox4x32::BATCH), static_cast<std::uint32_t>(row),
+                  stream, static_cast<std::uint32_t>(row >> 32), bits);
+        const std::size_t first = base < colBegin ? colBegin : base;
+        const std::size_t last = base + RANDOM_GROUP < colEnd ? base + RANDOM_GROUP : colEnd;
+        for (std::size_t col = first; col < last; col++)
+            out[col] = static_cast<T>(static_cast<std::int32_t>(scaleToRange(bits[col - base], range)));
+    }
+}
+
+// Fills `matrix` with random matrix `stream` in parallel, tile by tile with the
+// static schedule (the same first-touch layout as parallelFill). The contents
+// depend only on (seed, stream), never on the thread count or schedule.
+template <typename T>
+void fillRandom(ThreadPool &pool, Matrix<T> &matrix, std::uint32_t stream, std::uint64_t seed = DEFAULT_SEED,
+                std::uint32_t range = valueRange<T>())
+{
+    const Philox4x32 rng(seed);
+    const int rows = static_cast<int>(matrix.rows());
+    const int cols = static_cast<int>(matrix.cols());
+    std::vector<Tile> tiles = makeTiles(rows, cols, defaultTileShape(cols, sizeof(T)));
+    runTiles(pool, tiles, Schedule::Static, [&](int, const Tile &tile)
+             {
+                 for (int r = tile.row; r < tile.row + tile.rows; r++)
+                     randomRow(rng, stream, r, tile.col, tile.col + tile.cols, matrix.row(r).data(), range);
+             });
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "expr.h"
+#include "gemm.h"
+#include "matrix_add.h"
+#include "options.h"
+#include "rng.h"
+#include "roofline.h"
+
+// Largest square GEMM timed; bigger --rows only slow the report down, since
+// GEMM is compute-bound well before this size.
+constexpr int ROOFLINE_GEMM_LIMIT = 1024;
+
+// Measures the machine's roofs (STREAM triad bandwidth over --stream-mb, peak
+// double-precision FLOP/s from a register-only FMA loop on every worker) and
+// places the module14 f64 kernels on them. Bytes are the compulsory traffic of
+// one call, so an intensity below the ridge means no kernel of that shape can
+// beat the bandwidth roof. Prints a table and a text chart; --csv, --svg and
+// --json write the points, the chart and the raw timings.
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options,
+                      OPT_SHAPE | OPT_POOL_BENCH | OPT_SCHEDULE | OPT_OUTPUT | OPT_SVG | OPT_STREAM_MB))
+        return 1;
+
+    ThreadPool pool(options.threads, options.wake);
+    const std::string pin = applyPinning(pool, options);
+    const Isa isa = detectIsa();
+    const int streamMb = options.streamMb > 0 ? options.streamMb : DEFAULT_STREAM_MB;
+
+    Roofline roof;
+    roof.peakGbs = measureStreamTriad(pool, std::size_t(streamMb) * 1024 * 1024 / (3 * sizeof(double)), options.reps);
+    roof.peakGflops = measurePeakGflops(pool, isa, options.reps);
+    std::cout << pool.size() << " threads, " << isaName(isa) << ", STREAM triad over " << streamMb << " MB\n\n";
+
+    const std::size_t rows = options.rows, cols = options.cols;
+    const double elements = static_cast<double>(rows) * cols;
+    Matrix<double> a(rows, cols), b(rows, cols), c(rows, cols), out(rows, cols);
+    fillRandom(pool, a, LEFT_STREAM, options.seed);
+    fillRandom(pool, b, RIGHT_STREAM, options.seed);
+    fillRandom(pool, c, LEFT_STREAM + 2, options.seed);
+
+    std::vector<RooflinePoint> points;
+    std::vector<BenchRecord> records;
+    double checksum = 0;
+    auto place = [&](const std::string &kernel, std::size_t r, std::size_t k, double flops, double bytes,
+                     auto &&body)
+    {
+        BenchRecord record;
+        record.kernel = kernel;
+        record.rows = r;
+        record.cols = k;
+        record.threads = pool.size();
+        record.bytes = bytes;
+        record.stats = measure(options.warmups, options.reps, body);
+        RooflinePoint point{kernel, flops, bytes, record.stats.medianNs};
+        record.tags = {{"flops", std::to_string(flops)},
+                       {"intensity", std::to_string(point.intensity())},
+                       {"bound", memoryBound(roof, point) ? "memory" : "compute"},
+                       {"pin", pin}};
+        records.push_back(record);
+        points.push_back(point);
+    };
+
+    // Each streaming kernel also sums its result, as every module14 kernel does.
+    place("add", rows, cols, 2 * elements, 3 * sizeof(double) * elements,
+          [&] { checksum += matrixAdd(pool, a, b, out, options.schedule); });
+    place("expr a+2b-c", rows, cols, 4 * elements, 4 * sizeof(double) * elements,
+          [&] { checksum += assign(pool, out, a + 2.0 * b - c, options.schedule); });
+    place("sum", rows, cols, elements, sizeof(double) * elements, [&] { checksum += sum(pool, a); });
+    place("dot a.b", rows, cols, 2 * elements, 2 * sizeof(double) * elements, [&] { checksum += sum(pool, a * b); });
+
+    const int n = std::min(static_cast<int>(std::min(rows, cols)), ROOFLINE_GEMM_LIMIT);
+    Matrix<double> ga(n, n), gb(n, n), gc(n, n);
+    fillRandom(pool, ga, LEFT_STREAM, options.seed);
+    fillRandom(pool, gb, RIGHT_STREAM, options.seed);
+    const double cube = static_cast<double>(n) * n * n;
+    place("gemm " + std::to_string(n), n, n, 2 * cube, 3.0 * sizeof(double) * n * n,
+          [&] { matrixMultiply(pool, ga, gb, gc); });
+    checksum += gc(0, 0);
+
+    printRoofline(std::cout, roof, points);
+    std::cout << "(checksum " << checksum << ")\n";
+
+    if (!options.csvPath.empty() && !writeRooflineCsv(options.csvPath, roof, points))
+        std::cerr << "Cannot write " << options.csvPath << "\n";
+    if (!options.svgPath.empty() && !writeRooflineSvg(options.svgPath, roof, points))
+        std::cerr << "Cannot write " << options.svgPath << "\n";
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, records, 0))
+        std::cerr << "Cannot write " << options.jsonPath << "\n";
+    return 0;
+}
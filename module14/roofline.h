@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "simd_kernels.h"
+#include "thread_pool.h"
+#include "timing.h"
+
+// Roofline model: a kernel doing `flops` floating-point operations while moving
+// `bytes` to and from memory has arithmetic intensity I = flops / bytes and
+// can reach at most min(peak FLOP/s, I x peak bandwidth). Kernels left of the
+// ridge point (peak FLOP/s / peak bandwidth) are memory-bound: no amount of
+// instruction-level work brings them past the bandwidth roof.
+
+// Rounds of the peak FLOP loop per worker per timed run (about 10 ms per core).
+constexpr std::size_t PEAK_FLOP_ITERATIONS = std::size_t(1) << 22;
+
+struct Roofline
+{
+    double peakGflops = 0; // all workers, double precision
+    double peakGbs = 0;    // STREAM triad
+
+    // Intensity (flop/byte) where the bandwidth roof meets the compute roof.
+    double ridge() const { return peakGbs > 0 ? peakGflops / peakGbs : 0; }
+    double attainable(double intensity) const { return std::min(peakGflops, intensity * peakGbs); }
+};
+
+// One kernel placed on the roofline, per call.
+struct RooflinePoint
+{
+    std::string kernel;
+    double flops = 0;
+    double bytes = 0; // compulsory traffic: each operand read or written once
+    double nanos = 0; // median time per call
+
+    double intensity() const { return bytes > 0 ? flops / bytes : 0; }
+    double gflops() const { return nanos > 0 ? flops / nanos : 0; }
+    double gbs() const { return nanos > 0 ? bytes / nanos : 0; }
+};
+
+// Peak double-precision GFLOP/s of `pool`: every worker runs the register-only
+// peakFlops loop at `isa` at once; the best of `reps` runs counts.
+inline double measurePeakGflops(ThreadPool &pool, Isa isa, int reps)
+{
+    std::vector<double> flops(pool.size()), checksums(pool.size());
+    TimingStats stats = measure(1, reps, [&]
+                                {
+                                    pool.run([&](int worker)
+                                             { flops[worker] = peakFlops(isa, PEAK_FLOP_ITERATIONS, checksums[worker]); });
+                                });
+    double total = 0;
+    for (double f : flops)
+        total += f;
+    return stats.minNs > 0 ? total / stats.minNs : 0;
+}
+
+inline bool memoryBound(const Roofline &roof, const RooflinePoint &point)
+{
+    return point.intensity() < roof.ridge();
+}
+
+// kernel, flops, bytes, intensity, achieved and attainable GFLOP/s, fraction of
+// the roof reached and which roof bounds it; the peaks repeat on every row.
+inline bool writeRooflineCsv(const std::string &path, const Roofline &roof, const std::vector<RooflinePoint> &points)
+{
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    out << "kernel,flops,bytes,median_ns,intensity,gflops,gbs,roof_gflops,roof_fraction,bound,peak_gflops,peak_gbs\n"
+        << std::setprecision(10);
+    for (const RooflinePoint &p : points)
+    {
+        const double roofGflops = roof.attainable(p.intensity());
+        out << p.kernel << "," << p.flops << "," << p.bytes << "," << p.nanos << "," << p.intensity() << ","
+            << p.gflops() << "," << p.gbs() << "," << roofGflops << "," << (roofGflops > 0 ? p.gflops() / roofGflops : 0)
+            << "," << (memoryBound(roof, p) ? "memory" : "compute") << "," << roof.peakGflops << "," << roof.peakGbs
+            << "\n";
+    }
+    return true;
+}
+
+// Log-log axis ranges that hold the roof's ridge and every point, in whole
+// powers of two (intensity) and ten (GFLOP/s).
+struct RooflineAxes
+{
+    double minLog2X, maxLog2X;
+    double minLog10Y, maxLog10Y;
+
+    RooflineAxes(const Roofline &roof, const std::vector<RooflinePoint> &points)
+    {
+        double lowX = roof.ridge(), highX = roof.ridge(), lowY = roof.peakGflops;
+        for (const RooflinePoint &p : points)
+            if (p.intensity() > 0 && p.gflops() > 0)
+            {
+                lowX = std::min(lowX, p.intensity());
+                highX = std::max(highX, p.intensity());
+                lowY = std::min(lowY, p.gflops());
+            }
+        minLog2X = std::floor(std::log2(lowX)) - 1;
+        maxLog2X = std::ceil(std::log2(highX)) + 1;
+        minLog10Y = std::floor(std::log10(std::min(lowY, roof.attainable(std::exp2(minLog2X)))));
+        maxLog10Y = std::ceil(std::log10(roof.peakGflops * 1.01));
+    }
+
+    // Position of (intensity, gflops) as fractions of the axes, 0..1.
+    double x(double intensity) const { return (std::log2(intensity) - minLog2X) / (maxLog2X - minLog2X); }
+    double y(double gflops) const { return (std::log10(gflops) - minLog10Y) / (maxLog10Y - minLog10Y); }
+};
+
+// Letter used for point `index` in the charts.
+inline char rooflineMarker(std::size_t index)
+{
+    return static_cast<char>(index < 26 ? 'A' + index : 'a' + (index - 26) % 26);
+}
+
+// Text chart: the roof drawn with '/' (bandwidth) and '_' (compute), each
+// kernel as a letter, followed by a legend.
+inline void printRoofline(std::ostream &out, const Roofline &roof, const std::vector<RooflinePoint> &points)
+{
+    constexpr int WIDTH = 64;
+    constexpr int HEIGHT = 18;
+    const RooflineAxes axes(roof, points);
+    std::vector<std::string> grid(HEIGHT, std::string(WIDTH, ' '));
+    auto rowOf = [&](double gflops)
+    {
+        const int row = static_cast<int>(std::lround((1 - axes.y(gflops)) * (HEIGHT - 1)));
+        return std::clamp(row, 0, HEIGHT - 1);
+    };
+    auto columnOf = [&](double intensity)
+    {
+        const int column = static_cast<int>(std::lround(axes.x(intensity) * (WIDTH - 1)));
+        return std::clamp(column, 0, WIDTH - 1);
+    };
+
+    for (int column = 0; column < WIDTH; column++)
+    {
+        const double intensity =
+            std::exp2(axes.minLog2X + (axes.maxLog2X - axes.minLog2X) * column / static_cast<double>(WIDTH - 1));
+        grid[rowOf(roof.attainable(intensity))][column] = intensity < roof.ridge() ? '/' : '_';
+    }
+    // Points that land on another letter move right until they find a free cell.
+    for (std::size_t i = 0; i < points.size(); i++)
+        if (points[i].intensity() > 0 && points[i].gflops() > 0)
+        {
+            std::string &line = grid[rowOf(points[i].gflops())];
+            int column = columnOf(points[i].intensity());
+            while (column < WIDTH - 1 && std::isalpha(static_cast<unsigned char>(line[column])))
+                column++;
+            line[column] = rooflineMarker(i);
+        }
+
+    out << "GFLOP/s (log)\n" << std::setprecision(3);
+    for (int row = 0; row < HEIGHT; row++)
+    {
+        out << std::setw(9);
+        if (row == 0 || row == HEIGHT - 1)
+            out << std::pow(10.0, row == 0 ? axes.maxLog10Y : axes.minLog10Y);
+        else
+            out << "";
+        out << " |" << grid[row] << "\n";
+    }
+    out << std::setw(11) << "+" << std::string(WIDTH, '-') << "\n";
+    out << std::setw(11) << "" << std::left << std::setw(WIDTH - 8) << std::exp2(axes.minLog2X) << std::right
+        << std::exp2(axes.maxLog2X) << "\n";
+    out << std::setw(11) << "" << "arithmetic intensity, flop/byte (log)\n\n";
+
+    out << "Peak " << std::setprecision(4) << roof.peakGflops << " GFLOP/s, " << roof.peakGbs
+        << " GB/s, ridge at " << roof.ridge() << " flop/byte\n";
+    for (std::size_t i = 0; i < points.size(); i++)
+    {
+        const RooflinePoint &p = points[i];
+        const double roofGflops = roof.attainable(p.intensity());
+        out << "  " << rooflineMarker(i) << " " << std::left << std::setw(14) << p.kernel << std::right << std::fixed
+            << std::setprecision(3) << std::setw(9) << p.intensity() << " flop/B" << std::setprecision(2)
+            << std::setw(9) << p.gflops() << " GFLOP/s" << std::setprecision(1) << std::setw(7)
+            << (roofGflops > 0 ? 100 * p.gflops() / roofGflops : 0) << "% of roof, "
+            << (memoryBound(roof, p) ? "memory" : "compute") << "-bound"
+            << (p.gflops() > roofGflops * 1.25 ? " (above the roof: operands served from cache)" : "") << "\n";
+        out.unsetf(std::ios::fixed);
+    }
+    out << std::setprecision(6);
+}
+
+// The same chart as an SVG file with labelled log axes.
+inline bool writeRooflineSvg(const std::string &path, const Roofline &roof, const std::vector<RooflinePoint> &points)
+{
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    constexpr double WIDTH = 720, HEIGHT = 480, LEFT = 70, RIGHT = 20, TOP = 20, BOTTOM = 50;
+    const double plotWidth = WIDTH - LEFT - RIGHT, plotHeight = HEIGHT - TOP - BOTTOM;
+    const RooflineAxes axes(roof, points);
+    auto px = [&](double intensity) { return LEFT + axes.x(intensity) * plotWidth; };
+    auto py = [&](double gflops) { return TOP + (1 - axes.y(gflops)) * plotHeight; };
+
+    out << std::setprecision(6) << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << WIDTH << "\" height=\""
+        << HEIGHT << "\" font-family=\"sans-serif\" font-size=\"12\">\n"
+        << "<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n";
+    for (int e = static_cast<int>(axes.minLog2X); e <= static_cast<int>(axes.maxLog2X); e++)
+    {
+        const double x = px(std::exp2(e));
+        out << "<line x1=\"" << x << "\" y1=\"" << TOP << "\" x2=\"" << x << "\" y2=\"" << TOP + plotHeight
+            << "\" stroke=\"#ddd\"/>\n<text x=\"" << x << "\" y=\"" << TOP + plotHeight + 16
+            << "\" text-anchor=\"middle\">" << std::exp2(e) << "</text>\n";
+    }
+    for (int e = static_cast<int>(axes.minLog10Y); e <= static_cast<int>(axes.maxLog10Y); e++)
+    {
+        const double y = py(std::pow(10.0, e));
+        out << "<line x1=\"" << LEFT << "\" y1=\"" << y << "\" x2=\"" << LEFT + plotWidth << "\" y2=\"" << y
+            << "\" stroke=\"#ddd\"/>\n<text x=\"" << LEFT - 6 << "\" y=\"" << y + 4 << "\" text-anchor=\"end\">"
+            << std::pow(10.0, e) << "</text>\n";
+    }
+    out << "<text x=\"" << LEFT + plotWidth / 2 << "\" y=\"" << HEIGHT - 10
+        << "\" text-anchor=\"middle\">arithmetic intensity (flop/byte)</text>\n"
+        << "<text x=\"16\" y=\"" << TOP + plotHeight / 2 << "\" text-anchor=\"middle\" transform=\"rotate(-90 16 "
+        << TOP + plotHeight / 2 << ")\">GFLOP/s</text>\n";
+
+    const double left = std::exp2(axes.minLog2X), right = std::exp2(axes.maxLog2X);
+    out << "<polyline fill=\"none\" stroke=\"#c00\" stroke-width=\"2\" points=\"" << px(left) << ","
+        << py(roof.attainable(left)) << " " << px(roof.ridge()) << "," << py(roof.peakGflops) << " " << px(right)
+        << "," << py(roof.peakGflops) << "\"/>\n";
+    out << "<text x=\"" << px(right) - 4 << "\" y=\"" << py(roof.peakGflops) - 6 << "\" text-anchor=\"end\" fill=\"#c00\">"
+        << roof.peakGflops << " GFLOP/s, " << roof.peakGbs << " GB/s</text>\n";
+
+    for (std::size_t i = 0; i < points.size(); i++)
+    {
+        const RooflinePoint &p = points[i];
+        if (p.intensity() <= 0 || p.gflops() <= 0)
+            continue;
+        out << "<circle cx=\"" << px(p.intensity()) << "\" cy=\"" << py(p.gflops()) << "\" r=\"4\" fill=\""
+            << (memoryBound(roof, p) ? "#06c" : "#080") << "\"/>\n<text x=\"" << px(p.intensity()) + 6 << "\" y=\""
+            << py(p.gflops()) - 6 << "\">" << p.kernel << "</text>\n";
+    }
+    out << "</svg>\n";
+    return true;
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "matrix.h"
+#include "thread_pool.h"
+
+// Bytes of all streams touched by one tile; sized to sit comfortably in L2.
+constexpr std::size_t TILE_BYTES = 256 * 1024;
+// Widest tile in bytes per row, so tall narrow matrices still get several tiles.
+constexpr std::size_t TILE_MAX_ROW_BYTES = 8 * 1024;
+// Tiles claimed per grab by the dynamic schedule.
+constexpr int DEFAULT_CHUNK = 4;
+
+// Per-worker value on its own cache line, so workers updating neighbouring
+// entries of a std::vector<Padded<T>> do not false-share.
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) Padded
+{
+    T value{};
+};
+
+// Rectangular block of matrix elements: rows [row, row + rows), cols [col, col + cols).
+struct Tile
+{
+    int row;
+    int col;
+    int rows;
+    int cols;
+};
+
+struct TileShape
+{
+    int rows;
+    int cols;
+};
+
+// Picks a tile whose `streams` matrices of `elementSize`-byte elements fit in
+// TILE_BYTES. Tile widths are whole cache lines so tiles never share a line.
+inline TileShape defaultTileShape(int cols, std::size_t elementSize, int streams = 3)
+{
+    const std::size_t perLine = CACHE_LINE_SIZE / elementSize;
+    std::size_t tileCols = TILE_MAX_ROW_BYTES / elementSize;
+    if (static_cast<std::size_t>(cols) <= tileCols)
+        tileCols = cols;
+    else
+        tileCols = tileCols / perLine * perLine;
+
+    std::size_t tileRows = TILE_BYTES / (streams * elementSize * tileCols);
+    return TileShape{tileRows > 0 ? static_cast<int>(tileRows) : 1, static_cast<int>(tileCols)};
+}
+
+// Covers a rows x cols matrix with tiles in row-major tile order; edge tiles are clipped.
+inline std::vector<Tile> makeTiles(int rows, int cols, TileShape shape)
+{
+    std::vector<Tile> tiles;
+    for (int r = 0; r < rows; r += shape.rows)
+        for (int c = 0; c < cols; c += shape.cols)
+            tiles.push_back(Tile{r, c, r + shape.rows <= rows ? shape.rows : rows - r,
+                                 c + shape.cols <= cols ? shape.cols : cols - c});
+    return tiles;
+}
+
+// How tiles are handed to pool workers.
+//   Static       - contiguous block of tiles per worker, fixed up front.
+//   Dynamic      - workers claim DEFAULT_CHUNK tiles at a time from a shared counter.
+//   WorkStealing - each worker owns a contiguous block; an idle worker steals the
+//                  upper half of a busy worker's remaining tiles.
+enum class Schedule
+{
+    Static,
+    Dynamic,
+    WorkStealing
+};
+
+constexpr Schedule ALL_SCHEDULES[] = {Schedule::Static, Schedule::Dynamic, Schedule::WorkStealing};
+
+inline const char *scheduleName(Schedule schedule)
+{
+    switch (schedule)
+    {
+    case Schedule::Static:       return "static";
+    case Schedule::Dynamic:      return "dynamic";
+    case Schedule::WorkStealing: return "steal";
+    }
+    return "unknown";
+}
+
+// Per-worker ranges of tile indices. Each range [head, tail) is packed into one
+// 64-bit word so the owner (popping at head) and thieves (splitting off the
+// tail) can both update it with a single compare-and-swap.
+class StealingRanges
+{
+public:
+    StealingRanges(int workers, int count) : ranges_(workers)
+    {
+        for (int w = 0; w < workers; w++)
+        {
+            std::uint32_t head = static_cast<std::uint32_t>(static_cast<long long>(count) * w / workers);
+            std::uint32_t tail = static_cast<std::uint32_t>(static_cast<long long>(count) * (w + 1) / workers);
+            ranges_[w].bounds.store(pack(head, tail), std::memory_order_relaxed);
+        }
+    }
+
+    // Takes the next tile from the worker's own range.
+    bool pop(int worker, int &index)
+    {
+        std::atomic<std::uint64_t> &bounds = ranges_[worker].bounds;
+        std::uint64_t current = bounds.load(std::memory_order_acquire);
+        for (;;)
+        {
+            std::uint32_t head = headOf(current), tail = tailOf(current);
+            if (head >= tail)
+                return false;
+            if (bounds.compare_exchange_weak(current, pack(head + 1, tail), std::memory_order_acq_rel))
+            {
+                index = static_cast<int>(head);
+                return true;
+            }
+        }
+    }
+
+    // Moves the upper half of some other worker's range into `thief`'s (empty)
+    // range and returns its first tile.
+    bool steal(int thief, int &index)
+    {
+        const int workers = static_cast<int>(ranges_.size());
+        for (int offset = 1; offset < workers; offset++)
+        {
+            std::atomic<std::uint64_t> &victim = ranges_[(thief + offset) % workers].bounds;
+            std::uint64_t current = victim.load(std::memory_order_acquire);
+            for (;;)
+            {
+                std::uint32_t head = headOf(current), tail = tailOf(current);
+                if (head >= tail)
+                    break;
+                std::uint32_t mid = head + (tail - head) / 2;
+                if (victim.compare_exchange_weak(current, pack(head, mid), std::memory_order_acq_rel))
+                {
+                    ranges_[thief].bounds.store(pack(mid + 1, tail), std::memory_order_release);
+                    index = static_cast<int>(mid);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Range
+    {
+        std::atomic<std::uint64_t> bounds{0};
+    };
+
+    static std::uint64_t pack(std::uint32_t head, std::uint32_t tail) { return (std::uint64_t(head) << 32) | tail; }
+    static std::uint32_t headOf(std::uint64_t bounds) { return static_cast<std::uint32_t>(bounds >> 32); }
+    static std::uint32_t tailOf(std::uint64_t bounds) { return static_cast<std::uint32_t>(bounds); }
+
+    std::vector<Range> ranges_;
+};
+
+// Calls fn(worker, tile) exactly once for every tile, spread over `pool`
+// according to `schedule`.
+template <typename Fn>
+void runTiles(ThreadPool &pool, const std::vector<Tile> &tiles, Schedule schedule, Fn fn, int chunk = DEFAULT_CHUNK)
+{
+    const int count = static_cast<int>(tiles.size());
+    const int workers = pool.size();
+
+    switch (schedule)
+    {
+    case Schedule::Static:
+        pool.parallelFor(0, count, [&](int worker, int begin, int end)
+                         {
+                             for (int i = begin; i < end; i++)
+                                 fn(worker, tiles[i]);
+                         });
+        break;
+
+    case Schedule::Dynamic:
+    {
+        std::atomic<int> next{0};
+        pool.run([&](int worker)
+                 {
+                     for (int begin = next.fetch_add(chunk); begin < count; begin = next.fetch_add(chunk))
+                     {
+                         int end = begin + chunk < count ? begin + chunk : count;
+                         for (int i = begin; i < end; i++)
+                             fn(worker, tiles[i]);
+                     }
+                 });
+        break;
+    }
+
+    case Schedule::WorkStealing:
+    {
+        StealingRanges ranges(workers, count);
+        pool.run([&](int worker)
+                 {
+                     int index;
+                     while (ranges.pop(worker, index) || ranges.steal(worker, index))
+                         fn(worker, tiles[index]);
+                 });
+        break;
+    }
+    }
+}
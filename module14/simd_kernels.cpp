@@ -0,0 +1,654 @@
+#include "simd_kernels.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MODULE14_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+
+template <typename T>
+AccumulatorOf<T> addScalar(const T *left, const T *right, T *result, std::size_t count)
+{
+    AccumulatorOf<T> sum = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        T value = wrappingAdd(left[i], right[i]);
+        result[i] = value;
+        sum += value;
+    }
+    return sum;
+}
+
+// Partial sums of the generic kernels. 8- and 16-bit data is summed in int32,
+// flushed to the int64 total every ADD_BLOCK elements (2^16 values of at most
+// 2^15 cannot overflow), so the vector loop stays narrow.
+template <typename T>
+struct PartialOf
+{
+    using type = AccumulatorOf<T>;
+};
+template <>
+struct PartialOf<std::int16_t>
+{
+    using type = std::int32_t;
+};
+template <>
+struct PartialOf<std::int8_t>
+{
+    using type = std::int32_t;
+};
+template <>
+struct PartialOf<std::uint8_t>
+{
+    using type = std::int32_t;
+};
+
+constexpr std::size_t ADD_BLOCK = std::size_t(1) << 16;
+// Independent float sums: floating-point adds may not be reordered, so the
+// reduction only vectorizes when split into lanes explicitly.
+constexpr std::size_t ADD_FLOAT_LANES = 16;
+
+// Element-type-generic add written so the compiler vectorizes it for whatever
+// target the wrapper below is built for. Integer sums are exact in any order.
+template <typename T>
+inline __attribute__((always_inline)) AccumulatorOf<T> addGeneric(const T *left, const T *right, T *result,
+                                                                std::size_t count)
+{
+    using Partial = typename PartialOf<T>::type;
+    AccumulatorOf<T> total = 0;
+    std::size_t i = 0;
+    if constexpr (std::is_integral<T>::value)
+    {
+        for (; i < count; i += ADD_BLOCK)
+        {
+            const std::size_t end = count - i < ADD_BLOCK ? count : i + ADD_BLOCK;
+            Partial partial = 0;
+            for (std::size_t k = i; k < end; k++)
+            {
+                T value = wrappingAdd(left[k], right[k]);
+                result[k] = value;
+                partial += value;
+            }
+            total += partial;
+        }
+        return total;
+    }
+    else
+    {
+        Partial lanes[ADD_FLOAT_LANES] = {};
+        for (; i + ADD_FLOAT_LANES <= count; i += ADD_FLOAT_LANES)
+            for (std::size_t j = 0; j < ADD_FLOAT_LANES; j++)
+            {
+                T value = left[i + j] + right[i + j];
+                result[i + j] = value;
+                lanes[j] += value;
+            }
+        for (Partial lane : lanes)
+            total += lane;
+        return total + addScalar(left + i, right + i, result + i, count - i);
+    }
+}
+
+template <typename T>
+AccumulatorOf<T> addGenericBaseline(const T *left, const T *right, T *result, std::size_t count)
+{
+    return addGeneric(left, right, result, count);
+}
+
+// `Bytes` of T as one GCC vector.
+template <typename T, std::size_t Bytes>
+struct VectorOf
+{
+    typedef T type __attribute__((vector_size(Bytes)));
+};
+
+// Independent multiply-add chains in the peak FLOP loop: enough to hide the
+// FMA latency on two ports (4 cycles x 2) with room to spare.
+constexpr int PEAK_CHAINS = 12;
+
+// `iterations` rounds of chain = chain * scale + offset on PEAK_CHAINS vectors
+// of Bytes / 8 doubles, contracted to FMAs where the target has them. Returns
+// the sum of the chains so the loop is not optimized away.
+template <std::size_t Bytes>
+inline __attribute__((always_inline)) double peakFlopsLoop(std::size_t iterations)
+{
+    using Vector = typename VectorOf<double, Bytes>::type;
+    constexpr std::size_t LANES = Bytes / sizeof(double);
+    Vector chains[PEAK_CHAINS];
+    for (int k = 0; k < PEAK_CHAINS; k++)
+        chains[k] = Vector{} + (1.0 + k);
+    const Vector scale = Vector{} + 0.999999;
+    const Vector offset = Vector{} + 1e-6;
+    for (std::size_t i = 0; i < iterations; i++)
+        for (int k = 0; k < PEAK_CHAINS; k++)
+            chains[k] = chains[k] * scale + offset;
+    double total = 0;
+    for (int k = 0; k < PEAK_CHAINS; k++)
+        for (std::size_t lane = 0; lane < LANES; lane++)
+            total += chains[k][lane];
+    return total;
+}
+
+double peakFlopsBaseline(std::size_t iterations)
+{
+    return peakFlopsLoop<16>(iterations);
+}
+
+// Integer streaming kernels add this many bytes at a time into an L1-resident
+// buffer with addGeneric, then copy the buffer out with non-temporal stores:
+// widening 8- and 16-bit lines for the sum in vector form generates poor code.
+constexpr std::size_t STREAM_CHUNK_BYTES = 4096;
+
+// addGeneric with whole-line non-temporal stores: ordinary stores up to the
+// first 64-byte boundary of result, then aligned 64-byte lines handed to
+// `store` (inlined into the ISA wrappers below by flattening), then ordinary
+// stores for the tail and a store fence, so the streamed data is visible to
+// other threads once the kernel returns. Floating-point lines are computed
+// and summed as GCC vectors straight into the stores.
+template <typename T, typename Store>
+inline __attribute__((always_inline)) AccumulatorOf<T> addStreamingGeneric(const T *left, const T *right, T *result,
+                                                                         std::size_t count, Store store)
+{
+    constexpr std::size_t line = 64 / sizeof(T);
+    const std::size_t misaligned = reinterpret_cast<std::uintptr_t>(result) % 64;
+    const std::size_t head = std::min(count, misaligned % sizeof(T) ? count : (64 - misaligned) % 64 / sizeof(T));
+    AccumulatorOf<T> total = addScalar(left, right, result, head);
+    std::size_t i = head;
+    if constexpr (std::is_integral<T>::value)
+    {
+        constexpr std::size_t chunk = STREAM_CHUNK_BYTES / sizeof(T);
+        alignas(64) T buffer[chunk];
+        while (count - i >= line)
+        {
+            const std::size_t n = std::min(chunk, (count - i) / line * line);
+            total += addGeneric(left + i, right + i, buffer, n);
+            for (std::size_t k = 0; k < n; k += line)
+                store(result + i + k, buffer + k);
+            i += n;
+        }
+    }
+    else
+    {
+        using Line = typename VectorOf<T, 64>::type;
+        using SumLine = typename VectorOf<AccumulatorOf<T>, line * sizeof(AccumulatorOf<T>)>::type;
+        SumLine lanes = {};
+        for (; i + line <= count; i += line)
+        {
+            Line a, b;
+            std::memcpy(&a, left + i, sizeof(Line));
+            std::memcpy(&b, right + i, sizeof(Line));
+            const Line value = a + b;
+            lanes += __builtin_convertvector(value, SumLine);
+            store(result + i, &value);
+        }
+        for (std::size_t j = 0; j < line; j++)
+            total += lanes[j];
+    }
+    total += addScalar(left + i, right + i, result + i, count - i);
+    store.fence();
+    return total;
+}
+
+// Portable micro-kernel; the fixed MR x NR loops vectorize at the baseline ISA.
+void gemmPortable(int kc, const double *a, const double *b, double *c, std::size_t ldc, bool accumulate)
+{
+    double acc[GEMM_MR][GEMM_NR] = {};
+    for (int k = 0; k < kc; k++)
+    {
+        for (int i = 0; i < GEMM_MR; i++)
+            for (int j = 0; j < GEMM_NR; j++)
+                acc[i][j] += a[i] * b[j];
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+    for (int i = 0; i < GEMM_MR; i++)
+        for (int j = 0; j < GEMM_NR; j++)
+            c[i * ldc + j] = accumulate ? c[i * ldc + j] + acc[i][j] : acc[i][j];
+}
+
+#ifdef MODULE14_X86
+
+__attribute__((target("sse2")))
+double addSSE2(const double *left, const double *right, double *result, std::size_t count)
+{
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128d v0 = _mm_add_pd(_mm_loadu_pd(left + i), _mm_loadu_pd(right + i));
+        __m128d v1 = _mm_add_pd(_mm_loadu_pd(left + i + 2), _mm_loadu_pd(right + i + 2));
+        _mm_storeu_pd(result + i, v0);
+        _mm_storeu_pd(result + i + 2, v1);
+        acc0 = _mm_add_pd(acc0, v0);
+        acc1 = _mm_add_pd(acc1, v1);
+    }
+    acc0 = _mm_add_pd(acc0, acc1);
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc0);
+    return lanes[0] + lanes[1] + addScalar(left + i, right + i, result + i, count - i);
+}
+
+__attribute__((target("avx2")))
+double addAVX2(const double *left, const double *right, double *result, std::size_t count)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256d v0 = _mm256_add_pd(_mm256_loadu_pd(left + i), _mm256_loadu_pd(right + i));
+        __m256d v1 = _mm256_add_pd(_mm256_loadu_pd(left + i + 4), _mm256_loadu_pd(right + i + 4));
+        _mm256_storeu_pd(result + i, v0);
+        _mm256_storeu_pd(result + i + 4, v1);
+        acc0 = _mm256_add_pd(acc0, v0);
+        acc1 = _mm256_add_pd(acc1, v1);
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+    double lanes[2];
+    _mm_storeu_pd(lanes, half);
+    return lanes[0] + lanes[1] + addScalar(left + i, right + i, result + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+double addAVX512(const double *left, const double *right, double *result, std::size_t count)
+{
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512d v0 = _mm512_add_pd(_mm512_loadu_pd(left + i), _mm512_loadu_pd(right + i));
+        __m512d v1 = _mm512_add_pd(_mm512_loadu_pd(left + i + 8), _mm512_loadu_pd(right + i + 8));
+        _mm512_storeu_pd(result + i, v0);
+        _mm512_storeu_pd(result + i + 8, v1);
+        acc0 = _mm512_add_pd(acc0, v0);
+        acc1 = _mm512_add_pd(acc1, v1);
+    }
+    if (i < count)
+    {
+        __mmask8 mask = static_cast<__mmask8>((1u << (count - i < 8 ? count - i : 8)) - 1);
+        __m512d v = _mm512_add_pd(_mm512_maskz_loadu_pd(mask, left + i), _mm512_maskz_loadu_pd(mask, right + i));
+        _mm512_mask_storeu_pd(result + i, mask, v);
+        acc0 = _mm512_add_pd(acc0, v);
+        i += 8;
+        if (i < count)
+        {
+            mask = static_cast<__mmask8>((1u << (count - i)) - 1);
+            v = _mm512_add_pd(_mm512_maskz_loadu_pd(mask, left + i), _mm512_maskz_loadu_pd(mask, right + i));
+            _mm512_mask_storeu_pd(result + i, mask, v);
+            acc1 = _mm512_add_pd(acc1, v);
+        }
+    }
+    // Halve by hand, as in addAVX2. GCC 12's _mm512_reduce_add_pd, cast and
+    // unmasked extract all start from an undefined vector and trip
+    // -Wuninitialized; the zero-masked extract with every lane kept does not.
+    acc0 = _mm512_add_pd(acc0, acc1);
+    __m256d quarter =
+        _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xF, acc0, 0), _mm512_maskz_extractf64x4_pd(0xF, acc0, 1));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(quarter), _mm256_extractf128_pd(quarter, 1));
+    double lanes[2];
+    _mm_storeu_pd(lanes, half);
+    return lanes[0] + lanes[1];
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+AccumulatorOf<T> addGenericAVX2(const T *left, const T *right, T *result, std::size_t count)
+{
+    return addGeneric(left, right, result, count);
+}
+
+// Byte and word lanes need AVX512BW on top of the AVX512F baseline.
+template <typename T>
+__attribute__((target("avx512f,avx512bw")))
+AccumulatorOf<T> addGenericAVX512(const T *left, const T *right, T *result, std::size_t count)
+{
+    return addGeneric(left, right, result, count);
+}
+
+// Non-temporal copy of one aligned 64-byte line at each x86 level.
+struct StreamSSE2
+{
+    __attribute__((target("sse2"))) void operator()(void *to, const void *from) const
+    {
+        for (int k = 0; k < 4; k++)
+            _mm_stream_si128(static_cast<__m128i *>(to) + k, _mm_load_si128(static_cast<const __m128i *>(from) + k));
+    }
+    __attribute__((target("sse2"))) void fence() const { _mm_sfence(); }
+};
+
+struct StreamAVX2
+{
+    __attribute__((target("avx2"))) void operator()(void *to, const void *from) const
+    {
+        for (int k = 0; k < 2; k++)
+            _mm256_stream_si256(static_cast<__m256i *>(to) + k,
+                                _mm256_load_si256(static_cast<const __m256i *>(from) + k));
+    }
+    __attribute__((target("avx2"))) void fence() const { _mm_sfence(); }
+};
+
+struct StreamAVX512
+{
+    __attribute__((target("avx512f"))) void operator()(void *to, const void *from) const
+    {
+        _mm512_stream_si512(static_cast<__m512i *>(to), _mm512_load_si512(from));
+    }
+    __attribute__((target("avx512f"))) void fence() const { _mm_sfence(); }
+};
+
+// `flatten` inlines the target-specific store into each wrapper, where the
+// ISA matches; always_inline on the store itself would be rejected inside the
+// target-neutral addStreamingGeneric.
+template <typename T>
+__attribute__((flatten, target("sse2")))
+AccumulatorOf<T> addStreamingSSE2(const T *left, const T *right, T *result, std::size_t count)
+{
+    return addStreamingGeneric(left, right, result, count, StreamSSE2{});
+}
+
+template <typename T>
+__attribute__((flatten, target("avx2")))
+AccumulatorOf<T> addStreamingAVX2(const T *left, const T *right, T *result, std::size_t count)
+{
+    return addStreamingGeneric(left, right, result, count, StreamAVX2{});
+}
+
+template <typename T>
+__attribute__((flatten, target("avx512f,avx512bw")))
+AccumulatorOf<T> addStreamingAVX512(const T *left, const T *right, T *result, std::size_t count)
+{
+    return addStreamingGeneric(left, right, result, count, StreamAVX512{});
+}
+
+// 6 x 8 block held in twelve ymm accumulators; each k step broadcasts one
+// element of A per row and issues two FMAs against the 8-wide row of B.
+__attribute__((target("avx2,fma")))
+void gemmAVX2(int kc, const double *a, const double *b, double *c, std::size_t ldc, bool accumulate)
+{
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+    for (int k = 0; k < kc; k++)
+    {
+        __m256d b0 = _mm256_loadu_pd(b);
+        __m256d b1 = _mm256_loadu_pd(b + 4);
+        __m256d av = _mm256_broadcast_sd(a + 0);
+        c00 = _mm256_fmadd_pd(av, b0, c00);
+        c01 = _mm256_fmadd_pd(av, b1, c01);
+        av = _mm256_broadcast_sd(a + 1);
+        c10 = _mm256_fmadd_pd(av, b0, c10);
+        c11 = _mm256_fmadd_pd(av, b1, c11);
+        av = _mm256_broadcast_sd(a + 2);
+        c20 = _mm256_fmadd_pd(av, b0, c20);
+        c21 = _mm256_fmadd_pd(av, b1, c21);
+        av = _mm256_broadcast_sd(a + 3);
+        c30 = _mm256_fmadd_pd(av, b0, c30);
+        c31 = _mm256_fmadd_pd(av, b1, c31);
+        av = _mm256_broadcast_sd(a + 4);
+        c40 = _mm256_fmadd_pd(av, b0, c40);
+        c41 = _mm256_fmadd_pd(av, b1, c41);
+        av = _mm256_broadcast_sd(a + 5);
+        c50 = _mm256_fmadd_pd(av, b0, c50);
+        c51 = _mm256_fmadd_pd(av, b1, c51);
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+
+    __m256d rows[GEMM_MR][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}, {c40, c41}, {c50, c51}};
+    for (int i = 0; i < GEMM_MR; i++)
+    {
+        double *row = c + i * ldc;
+        if (accumulate)
+        {
+            rows[i][0] = _mm256_add_pd(rows[i][0], _mm256_loadu_pd(row));
+            rows[i][1] = _mm256_add_pd(rows[i][1], _mm256_loadu_pd(row + 4));
+        }
+        _mm256_storeu_pd(row, rows[i][0]);
+        _mm256_storeu_pd(row + 4, rows[i][1]);
+    }
+}
+
+__attribute__((flatten, target("avx2,fma")))
+double peakFlopsAVX2(std::size_t iterations)
+{
+    return peakFlopsLoop<32>(iterations);
+}
+
+__attribute__((flatten, target("avx512f")))
+double peakFlopsAVX512(std::size_t iterations)
+{
+    return peakFlopsLoop<64>(iterations);
+}
+
+#endif // MODULE14_X86
+
+} // namespace
+
+const char *isaName(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa::Scalar: return "scalar";
+    case Isa::SSE2:   return "sse2";
+    case Isa::AVX2:   return "avx2";
+    case Isa::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+bool isaSupported(Isa isa)
+{
+#ifdef MODULE14_X86
+    __builtin_cpu_init();
+    switch (isa)
+    {
+    case Isa::Scalar: return true;
+    case Isa::SSE2:   return __builtin_cpu_supports("sse2");
+    case Isa::AVX2:   return __builtin_cpu_supports("avx2");
+    case Isa::AVX512: return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+#else
+    return isa == Isa::Scalar;
+#endif
+}
+
+Isa detectIsa()
+{
+    static const Isa detected = []
+    {
+        Isa best = Isa::Scalar;
+        for (Isa isa : ALL_ISAS)
+            if (isaSupported(isa))
+                best = isa;
+        return best;
+    }();
+    return detected;
+}
+
+namespace
+{
+
+// double keeps its hand-written kernels; other types use the generic ones.
+AddKernel selectAddKernel(Isa isa, const double *)
+{
+#ifdef MODULE14_X86
+    switch (isa)
+    {
+    case Isa::Scalar: return addScalar<double>;
+    case Isa::SSE2:   return addSSE2;
+    case Isa::AVX2:   return addAVX2;
+    case Isa::AVX512: return addAVX512;
+    }
+#endif
+    (void)isa;
+    return addScalar<double>;
+}
+
+template <typename T>
+AddKernelOf<T> selectAddKernel(Isa isa, const T *)
+{
+#ifdef MODULE14_X86
+    switch (isa)
+    {
+    case Isa::Scalar: return addScalar<T>;
+    case Isa::SSE2:   return addGenericBaseline<T>;
+    case Isa::AVX2:   return addGenericAVX2<T>;
+    case Isa::AVX512: return __builtin_cpu_supports("avx512bw") ? addGenericAVX512<T> : addGenericAVX2<T>;
+    }
+#endif
+    return isa == Isa::Scalar ? addScalar<T> : addGenericBaseline<T>;
+}
+
+template <typename T>
+AddKernelOf<T> selectStreamingAddKernel(Isa isa)
+{
+#ifdef MODULE14_X86
+    switch (isa)
+    {
+    case Isa::Scalar: break;
+    case Isa::SSE2:   return addStreamingSSE2<T>;
+    case Isa::AVX2:   return addStreamingAVX2<T>;
+    case Isa::AVX512: return __builtin_cpu_supports("avx512bw") ? addStreamingAVX512<T> : addStreamingAVX2<T>;
+    }
+#endif
+    return selectAddKernel(isa, static_cast<const T *>(nullptr));
+}
+
+} // namespace
+
+template <typename T>
+AddKernelOf<T> addKernel(Isa isa)
+{
+    return selectAddKernel(isa, static_cast<const T *>(nullptr));
+}
+
+template <typename T>
+AddKernelOf<T> streamingAddKernel(Isa isa)
+{
+    return selectStreamingAddKernel<T>(isa);
+}
+
+template <typename T>
+AddKernelOf<T> addKernelFor(std::size_t bytes, StoreMode mode)
+{
+    static const AddKernelOf<T> streaming = streamingAddKernel<T>(detectIsa());
+    const bool stream = mode == StoreMode::Streaming || (mode == StoreMode::Auto && bytes > streamingStoreThreshold());
+    return stream ? streaming : activeAddKernel<T>();
+}
+
+const char *storeModeName(StoreMode mode)
+{
+    switch (mode)
+    {
+    case StoreMode::Auto:      return "auto";
+    case StoreMode::Normal:    return "normal";
+    case StoreMode::Streaming: return "stream";
+    }
+    return "unknown";
+}
+
+bool parseStoreMode(const std::string &text, StoreMode &mode)
+{
+    for (StoreMode candidate : ALL_STORE_MODES)
+        if (text == storeModeName(candidate))
+        {
+            mode = candidate;
+            return true;
+        }
+    return false;
+}
+
+std::size_t streamingStoreThreshold()
+{
+    static const std::size_t threshold = []
+    {
+        long bytes = 0;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+        bytes = ::sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+        // Some C libraries report 0; fall back to the largest cache in sysfs.
+        for (int index = 0; bytes <= 0 && index < 8; index++)
+        {
+            std::ifstream file("/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/size");
+            std::size_t kb = 0;
+            if (file >> kb)
+                bytes = std::max<long>(bytes, static_cast<long>(kb) * 1024);
+        }
+        return bytes > 0 ? static_cast<std::size_t>(bytes) : std::size_t(32) << 20;
+    }();
+    return threshold;
+}
+
+template <typename T>
+AddKernelOf<T> activeAddKernel()
+{
+    static const AddKernelOf<T> kernel = addKernel<T>(detectIsa());
+    return kernel;
+}
+
+#define MODULE14_INSTANTIATE_ADD(T)                                             \
+    template AddKernelOf<T> addKernel<T>(Isa isa);                              \
+    template AddKernelOf<T> streamingAddKernel<T>(Isa isa);                     \
+    template AddKernelOf<T> addKernelFor<T>(std::size_t bytes, StoreMode mode); \
+    template AddKernelOf<T> activeAddKernel<T>();
+
+MODULE14_INSTANTIATE_ADD(double)
+MODULE14_INSTANTIATE_ADD(float)
+MODULE14_INSTANTIATE_ADD(std::int32_t)
+MODULE14_INSTANTIATE_ADD(std::int16_t)
+MODULE14_INSTANTIATE_ADD(std::int8_t)
+MODULE14_INSTANTIATE_ADD(std::uint8_t)
+
+#undef MODULE14_INSTANTIATE_ADD
+
+GemmKernel gemmKernel(Isa isa)
+{
+#ifdef MODULE14_X86
+    if ((isa == Isa::AVX2 || isa == Isa::AVX512) && isaSupported(Isa::AVX2) && __builtin_cpu_supports("fma"))
+        return gemmAVX2;
+#endif
+    (void)isa;
+    return gemmPortable;
+}
+
+GemmKernel activeGemmKernel()
+{
+    static const GemmKernel kernel = gemmKernel(detectIsa());
+    return kernel;
+}
+
+double peakFlops(Isa isa, std::size_t iterations, double &checksum)
+{
+    std::size_t lanes = 2;
+#ifdef MODULE14_X86
+    if (isa == Isa::AVX512 && isaSupported(Isa::AVX512))
+    {
+        checksum = peakFlopsAVX512(iterations);
+        lanes = 8;
+    }
+    else if ((isa == Isa::AVX2 || isa == Isa::AVX512) && isaSupported(Isa::AVX2) && __builtin_cpu_supports("fma"))
+    {
+        checksum = peakFlopsAVX2(iterations);
+        lanes = 4;
+    }
+    else
+#endif
+        checksum = peakFlopsBaseline(iterations);
+    return 2.0 * PEAK_CHAINS * lanes * static_cast<double>(iterations);
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// Instruction-set levels with a dedicated add kernel, lowest first.
+enum class Isa
+{
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+constexpr Isa ALL_ISAS[] = {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512};
+
+// Element types with add kernels. Sums are taken in a wider Accumulator so
+// narrow data cannot overflow (integers) or lose low-order bits (float).
+template <typename T>
+struct ElementTraits;
+
+template <>
+struct ElementTraits<double>
+{
+    using Accumulator = double;
+    static constexpr const char *name = "f64";
+};
+
+template <>
+struct ElementTraits<float>
+{
+    using Accumulator = double;
+    static constexpr const char *name = "f32";
+};
+
+template <>
+struct ElementTraits<std::int32_t>
+{
+    using Accumulator = std::int64_t;
+    static constexpr const char *name = "i32";
+};
+
+template <>
+struct ElementTraits<std::int16_t>
+{
+    using Accumulator = std::int64_t;
+    static constexpr const char *name = "i16";
+};
+
+template <>
+struct ElementTraits<std::int8_t>
+{
+    using Accumulator = std::int64_t;
+    static constexpr const char *name = "i8";
+};
+
+template <>
+struct ElementTraits<std::uint8_t>
+{
+    using Accumulator = std::int64_t;
+    static constexpr const char *name = "u8";
+};
+
+template <typename T>
+using AccumulatorOf = typename ElementTraits<T>::Accumulator;
+
+constexpr const char *ELEMENT_TYPE_NAMES[] = {"f64", "f32", "i32", "i16", "i8", "u8"};
+
+// Calls fn(T{}) for the element type named `name` (an ELEMENT_TYPE_NAMES entry);
+// returns false for an unknown name.
+template <typename Fn>
+bool withElementType(const std::string &name, Fn fn)
+{
+    if (name == "f64")
+        fn(double{});
+    else if (name == "f32")
+        fn(float{});
+    else if (name == "i32")
+        fn(std::int32_t{});
+    else if (name == "i16")
+        fn(std::int16_t{});
+    else if (name == "i8")
+        fn(std::int8_t{});
+    else if (name == "u8")
+        fn(std::uint8_t{});
+    else
+        return false;
+    return true;
+}
+
+// a + b, wrapping to T for integers: the add is done unsigned, where overflow is
+// defined, so int32 wraps instead of being undefined behaviour.
+template <typename T>
+inline T wrappingAdd(T a, T b)
+{
+    if constexpr (std::is_integral<T>::value)
+    {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(static_cast<U>(a) + static_cast<U>(b)));
+    }
+    else
+        return a + b;
+}
+
+// result[i] = left[i] + right[i] for i in [0, count); returns the sum of result.
+// Integer results wrap to T as wrappingAdd does; the sum is of the stored
+// (wrapped) values.
+template <typename T>
+using AddKernelOf = AccumulatorOf<T> (*)(const T *left, const T *right, T *result, std::size_t count);
+
+using AddKernel = AddKernelOf<double>;
+
+const char *isaName(Isa isa);
+
+// True when this build contains a kernel for `isa` and the CPU can run it.
+bool isaSupported(Isa isa);
+
+// Highest supported level, read from CPUID once.
+Isa detectIsa();
+
+// Kernel for `isa`; instantiated in simd_kernels.cpp for every ElementTraits type.
+template <typename T = double>
+AddKernelOf<T> addKernel(Isa isa);
+
+// Kernel chosen at startup for the running CPU.
+template <typename T = double>
+AddKernelOf<T> activeAddKernel();
+
+// How add kernels write their result.
+//   Normal    - ordinary stores; the destination line is read into cache first
+//               (write-allocate), so a write-only output costs a third stream.
+//   Streaming - non-temporal stores that bypass the cache, then a store fence
+//               before returning. Only pays off once the operands no longer
+//               fit in the last-level cache: cached results are evicted.
+//   Auto      - Streaming above streamingStoreThreshold() bytes, else Normal.
+enum class StoreMode
+{
+    Auto,
+    Normal,
+    Streaming
+};
+
+constexpr StoreMode ALL_STORE_MODES[] = {StoreMode::Auto, StoreMode::Normal, StoreMode::Streaming};
+
+const char *storeModeName(StoreMode mode);
+
+bool parseStoreMode(const std::string &text, StoreMode &mode);
+
+// Kernel for `isa` that writes result with non-temporal stores. Falls back to
+// addKernel<T>(isa) where the ISA has none (Scalar, non-x86 builds).
+template <typename T = double>
+AddKernelOf<T> streamingAddKernel(Isa isa);
+
+// Bytes touched by one add (all operands) above which Auto picks streaming
+// stores: the last-level cache size, read once from sysconf/sysfs.
+std::size_t streamingStoreThreshold();
+
+// Kernel for an add touching `bytes` bytes under `mode`, at the detected ISA.
+template <typename T = double>
+AddKernelOf<T> addKernelFor(std::size_t bytes, StoreMode mode);
+
+// GEMM register block: a micro-kernel updates a GEMM_MR x GEMM_NR tile of C.
+constexpr int GEMM_MR = 6;
+constexpr int GEMM_NR = 8;
+
+// C[0..MR)[0..NR) (row stride ldc) = (accumulate ? C : 0) + A * B, where `a` is a
+// packed kc x MR sliver (MR values per k) and `b` a packed kc x NR sliver.
+using GemmKernel = void (*)(int kc, const double *a, const double *b, double *c, std::size_t ldc, bool accumulate);
+
+// AVX2 and AVX-512 hosts share the AVX2+FMA micro-kernel; hosts without FMA
+// fall back to the portable one.
+GemmKernel gemmKernel(Isa isa);
+
+GemmKernel activeGemmKernel();
+
+// Runs a register-only multiply-add loop of `iterations` rounds at `isa` (or
+// the nearest level below it the CPU supports) and returns the floating-point
+// operations it performed, counting a fused multiply-add as two. `checksum`
+// receives the loop's result so the work cannot be optimized away. Timing it
+// gives the core's peak double-precision FLOP rate.
+double peakFlops(Isa isa, std::size_t iterations, double &checksum);
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "matrix.h"
+#include "scheduler.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+// Coordinate form: one (row, col, value) triple per stored element, sorted
+// row-major by the conversions below. Cheap to build incrementally.
+template <typename T>
+struct CooMatrix
+{
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    std::vector<std::int32_t> rowIndex;
+    std::vector<std::int32_t> colIndex;
+    std::vector<T> values;
+
+    std::size_t nnz() const { return values.size(); }
+};
+
+// Compressed sparse rows: row r holds elements [rowStart[r], rowStart[r + 1])
+// of colIndex/values, with columns ascending.
+template <typename T>
+struct CsrMatrix
+{
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    std::vector<std::size_t> rowStart{0};
+    std::vector<std::int32_t> colIndex;
+    std::vector<T> values;
+
+    std::size_t nnz() const { return values.size(); }
+    double density() const { return rows && cols ? double(nnz()) / (double(rows) * cols) : 0; }
+};
+
+// Splits rows into `parts` contiguous ranges holding about the same number of
+// stored elements of `a` and `b` together (plus `rowWeight` per row for work
+// that touches every row), so one dense row among empty ones does not leave
+// the other workers idle. bounds[p]..bounds[p + 1] is part p.
+template <typename T>
+std::vector<int> balancedRows(const CsrMatrix<T> &a, const CsrMatrix<T> *b, int parts, std::size_t rowWeight = 1)
+{
+    const int rows = static_cast<int>(a.rows);
+    auto work = [&](int row)
+    { return a.rowStart[row] + (b ? b->rowStart[row] : 0) + rowWeight * static_cast<std::size_t>(row); };
+    const std::size_t total = work(rows);
+
+    std::vector<int> bounds(parts + 1, rows);
+    bounds[0] = 0;
+    for (int p = 1; p < parts; p++)
+    {
+        const std::size_t target = total / parts * p;
+        int lo = bounds[p - 1], hi = rows;
+        while (lo < hi)
+        {
+            const int mid = lo + (hi - lo) / 2;
+            if (work(mid) < target)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        bounds[p] = lo;
+    }
+    return bounds;
+}
+
+// Dense to CSR in two parallel passes: count the non-zeros of every row, turn
+// the counts into row offsets, then copy each row's non-zeros into place.
+template <typename T>
+CsrMatrix<T> toCsr(ThreadPool &pool, const Matrix<T> &dense)
+{
+    CsrMatrix<T> csr;
+    csr.rows = dense.rows();
+    csr.cols = dense.cols();
+    csr.rowStart.assign(csr.rows + 1, 0);
+    const int rows = static_cast<int>(csr.rows);
+
+    pool.parallelFor(0, rows, [&](int, int first, int last)
+                     {
+                         for (int r = first; r < last; r++)
+                         {
+                             const T *row = dense.row(r).data();
+                             std::size_t count = 0;
+                             for (std::size_t c = 0; c < csr.cols; c++)
+                                 count += row[c] != T(0);
+                             csr.rowStart[r + 1] = count;
+                         }
+                     });
+    std::partial_sum(csr.rowStart.begin(), csr.rowStart.end(), csr.rowStart.begin());
+
+    csr.colIndex.resize(csr.rowStart[rows]);
+    csr.values.resize(csr.rowStart[rows]);
+    pool.parallelFor(0, rows, [&](int, int first, int last)
+                     {
+                         for (int r = first; r < last; r++)
+                         {
+                             const T *row = dense.row(r).data();
+                             std::size_t out = csr.rowStart[r];
+                             for (std::size_t c = 0; c < csr.cols; c++)
+                                 if (row[c] != T(0))
+                                 {
+                                     csr.colIndex[out] = static_cast<std::int32_t>(c);
+                                     csr.values[out++] = row[c];
+                                 }
+                         }
+                     });
+    return csr;
+}
+
+// COO to CSR: a stable counting sort by row, then each row sorted by column
+// with duplicate coordinates summed, as COO assembly expects.
+template <typename T>
+CsrMatrix<T> toCsr(const CooMatrix<T> &coo)
+{
+    std::vector<std::size_t> start(coo.rows + 1, 0);
+    for (std::int32_t row : coo.rowIndex)
+        start[row + 1]++;
+    std::partial_sum(start.begin(), start.end(), start.begin());
+
+    std::vector<std::size_t> order(coo.nnz());
+    std::vector<std::size_t> next(start.begin(), start.end() - 1);
+    for (std::size_t i = 0; i < coo.nnz(); i++)
+        order[next[coo.rowIndex[i]]++] = i;
+
+    CsrMatrix<T> csr;
+    csr.rows = coo.rows;
+    csr.cols = coo.cols;
+    csr.rowStart.assign(coo.rows + 1, 0);
+    csr.colIndex.reserve(coo.nnz());
+    csr.values.reserve(coo.nnz());
+    for (std::size_t r = 0; r < coo.rows; r++)
+    {
+        std::sort(order.begin() + start[r], order.begin() + start[r + 1],
+                  [&](std::size_t x, std::size_t y) { return coo.colIndex[x] < coo.colIndex[y]; });
+        for (std::size_t k = start[r]; k < start[r + 1]; k++)
+        {
+            const std::size_t i = order[k];
+            if (csr.colIndex.size() > csr.rowStart[r] && csr.colIndex.back() == coo.colIndex[i])
+                csr.values.back() += coo.values[i];
+            else
+            {
+                csr.colIndex.push_back(coo.colIndex[i]);
+                csr.values.push_back(coo.values[i]);
+            }
+        }
+        csr.rowStart[r + 1] = csr.values.size();
+    }
+    return csr;
+}
+
+template <typename T>
+CooMatrix<T> toCoo(const CsrMatrix<T> &csr)
+{
+    CooMatrix<T> coo;
+    coo.rows = csr.rows;
+    coo.cols = csr.cols;
+    coo.colIndex = csr.colIndex;
+    coo.values = csr.values;
+    coo.rowIndex.resize(csr.nnz());
+    for (std::size_t r = 0; r < csr.rows; r++)
+        std::fill(coo.rowIndex.begin() + csr.rowStart[r], coo.rowIndex.begin() + csr.rowStart[r + 1],
+                  static_cast<std::int32_t>(r));
+    return coo;
+}
+
+template <typename T>
+CooMatrix<T> toCoo(ThreadPool &pool, const Matrix<T> &dense)
+{
+    return toCoo(toCsr(pool, dense));
+}
+
+// Writes `csr` into `dense` (same shape), zeros included.
+template <typename T>
+void toDense(ThreadPool &pool, const CsrMatrix<T> &csr, Matrix<T> &dense)
+{
+    if (dense.rows() != csr.rows || dense.cols() != csr.cols)
+        throw std::invalid_argument("toDense: shape mismatch");
+    pool.parallelFor(0, static_cast<int>(csr.rows), [&](int, int first, int last)
+                     {
+                         for (int r = first; r < last; r++)
+                         {
+                             T *row = dense.row(r).data();
+                             std::fill(row, row + csr.cols, T(0));
+                             for (std::size_t k = csr.rowStart[r]; k < csr.rowStart[r + 1]; k++)
+                                 row[csr.colIndex[k]] = csr.values[k];
+                         }
+                     });
+}
+
+// Sum of the stored values, over nnz-balanced row ranges.
+template <typename T>
+AccumulatorOf<T> sum(ThreadPool &pool, const CsrMatrix<T> &csr)
+{
+    const std::vector<int> bounds = balancedRows<T>(csr, nullptr, pool.size(), 0);
+    std::vector<Padded<AccumulatorOf<T>>> sums(pool.size());
+    pool.run([&](int worker)
+             {
+                 AccumulatorOf<T> total = 0;
+                 for (std::size_t k = csr.rowStart[bounds[worker]]; k < csr.rowStart[bounds[worker + 1]]; k++)
+                     total += csr.values[k];
+                 sums[worker].value = total;
+             });
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &partial : sums)
+        total += partial.value;
+    return total;
+}
+
+// result = a + b for CSR operands, returning the sum of result. Rows are split
+// into nnz-balanced ranges; each worker first counts the merged length of its
+// rows, the counts become row offsets, and then each worker merges its rows'
+// sorted column lists into place. Coordinates present in both operands are
+// kept even when they cancel, so the structure depends only on the inputs.
+template <typename T>
+AccumulatorOf<T> sparseAdd(ThreadPool &pool, const CsrMatrix<T> &a, const CsrMatrix<T> &b, CsrMatrix<T> &result)
+{
+    if (a.rows != b.rows || a.cols != b.cols)
+        throw std::invalid_argument("sparseAdd: shape mismatch");
+
+    result.rows = a.rows;
+    result.cols = a.cols;
+    result.rowStart.assign(a.rows + 1, 0);
+    const std::vector<int> bounds = balancedRows(a, &b, pool.size());
+
+    pool.run([&](int worker)
+             {
+                 for (int r = bounds[worker]; r < bounds[worker + 1]; r++)
+                 {
+                     std::size_t i = a.rowStart[r], j = b.rowStart[r], count = 0;
+                     const std::size_t iEnd = a.rowStart[r + 1], jEnd = b.rowStart[r + 1];
+                     while (i < iEnd && j < jEnd)
+                     {
+                         const std::int32_t ca = a.colIndex[i], cb = b.colIndex[j];
+                         i += ca <= cb;
+                         j += cb <= ca;
+                         count++;
+                     }
+                     result.rowStart[r + 1] = count + (iEnd - i) + (jEnd - j);
+                 }
+             });
+    std::partial_sum(result.rowStart.begin(), result.rowStart.end(), result.rowStart.begin());
+
+    result.colIndex.resize(result.rowStart[a.rows]);
+    result.values.resize(result.rowStart[a.rows]);
+    std::vector<Padded<AccumulatorOf<T>>> sums(pool.size());
+    pool.run([&](int worker)
+             {
+                 AccumulatorOf<T> total = 0;
+                 for (int r = bounds[worker]; r < bounds[worker + 1]; r++)
+                 {
+                     std::size_t i = a.rowStart[r], j = b.rowStart[r], out = result.rowStart[r];
+                     const std::size_t iEnd = a.rowStart[r + 1], jEnd = b.rowStart[r + 1];
+                     while (i < iEnd || j < jEnd)
+                     {
+                         const std::int32_t ca = i < iEnd ? a.colIndex[i] : INT32_MAX;
+                         const std::int32_t cb = j < jEnd ? b.colIndex[j] : INT32_MAX;
+                         T value = 0;
+                         if (ca <= cb)
+                             value = wrappingAdd(value, a.values[i++]);
+                         if (cb <= ca)
+                             value = wrappingAdd(value, b.values[j++]);
+                         result.colIndex[out] = ca < cb ? ca : cb;
+                         result.values[out++] = value;
+                         total += value;
+                     }
+                 }
+                 sums[worker].value = total;
+             });
+
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &partial : sums)
+        total += partial.value;
+    return total;
+}
+
+// result = sparse + dense (all dense shapes equal), returning the sum of
+// result. Each worker scatters a sparse row into a zeroed scratch row, runs the
+// dense add kernel over it and the dense row, then clears the scattered
+// entries: one dense read + write pass at kernel speed plus O(nnz) work.
+template <typename T>
+AccumulatorOf<T> sparseDenseAdd(ThreadPool &pool, const CsrMatrix<T> &sparse, const Matrix<T> &dense,
+                                Matrix<T> &result, AddKernelOf<T> kernel = activeAddKernel<T>())
+{
+    if (dense.rows() != sparse.rows || dense.cols() != sparse.cols || result.rows() != sparse.rows ||
+        result.cols() != sparse.cols)
+        throw std::invalid_argument("sparseDenseAdd: shape mismatch");
+
+    const std::vector<int> bounds = balancedRows<T>(sparse, nullptr, pool.size(), sparse.cols);
+    std::vector<Padded<AccumulatorOf<T>>> sums(pool.size());
+    Matrix<T> scratch(pool.size(), sparse.cols);
+    pool.run([&](int worker)
+             {
+                 T *row = scratch.row(worker).data();
+                 std::fill(row, row + sparse.cols, T(0));
+                 AccumulatorOf<T> total = 0;
+                 for (int r = bounds[worker]; r < bounds[worker + 1]; r++)
+                 {
+                     const std::size_t first = sparse.rowStart[r], last = sparse.rowStart[r + 1];
+                     for (std::size_t k = first; k < last; k++)
+                         row[sparse.colIndex[k]] = sparse.values[k];
+                     total += kernel(dense.row(r).data(), row, result.row(r).data(), sparse.cols);
+                     for (std::size_t k = first; k < last; k++)
+                         row[sparse.colIndex[k]] = T(0);
+                 }
+                 sums[worker].value = total;
+             });
+
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &partial : sums)
+        total += partial.value;
+    return total;
+}
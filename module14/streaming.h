@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "matrix_add.h"
+#include "matrix_file.h"
+#include "timing.h"
+
+// Rows per streamed chunk when the caller does not pick one: ~64 MB per
+// operand buffer, large enough that each pread/pwrite runs at disk speed.
+constexpr std::size_t DEFAULT_CHUNK_BYTES = std::size_t(64) << 20;
+
+// Where the time of one streaming pass went. Read and write time is spent on
+// the I/O thread and overlaps compute, so readNs + writeNs + computeNs exceeds
+// wallNs when the pipeline is doing its job.
+struct StreamStats
+{
+    double sum = 0;
+    std::size_t chunks = 0;
+    double bytesRead = 0;
+    double bytesWritten = 0;
+    double readNs = 0;
+    double writeNs = 0;
+    double computeNs = 0;
+    double wallNs = 0;
+
+    // Disk throughput while the I/O thread was busy.
+    double ioGBs() const { return gigabytes(bytesRead + bytesWritten, readNs + writeNs); }
+    // Bytes touched by the add kernel (two inputs, one output) per compute second.
+    double computeGBs() const { return gigabytes(bytesRead + bytesWritten, computeNs); }
+    // End-to-end rate, i.e. what the slower of the two stages allowed.
+    double wallGBs() const { return gigabytes(bytesRead + bytesWritten, wallNs); }
+
+private:
+    static double gigabytes(double bytes, double nanos) { return nanos > 0 ? bytes / nanos : 0; }
+};
+
+// Rows per chunk so that one operand buffer holds about `chunkBytes`.
+inline std::size_t chunkRowsFor(const MatrixFile &file, std::size_t chunkBytes = DEFAULT_CHUNK_BYTES)
+{
+    return std::max<std::size_t>(1, chunkBytes / std::max<std::size_t>(1, file.rowBytes()));
+}
+
+// Out-of-core result = left + right over matrix files that need not fit in
+// memory. Rows are streamed in chunks through two buffer slots: while the pool
+// adds chunk i from one slot, a separate I/O thread writes chunk i - 1's result
+// and reads chunk i + 1's operands into the other, so disk and compute overlap.
+// Both operand files must hold elements of type T. Returns the sum of the
+// result and the per-stage timings.
+template <typename T>
+StreamStats streamingAdd(ThreadPool &pool,
+                         const std::string &leftPath,
+                         const std::string &rightPath,
+                         const std::string &resultPath,
+                         std::size_t chunkRows = 0,
+                         Schedule schedule = Schedule::WorkStealing,
+                         AddKernelOf<T> kernel = activeAddKernel<T>())
+{
+    MatrixFile left = MatrixFile::open(leftPath);
+    MatrixFile right = MatrixFile::open(rightPath);
+    if (left.dtype() != DTypeOf<T>::value || right.dtype() != DTypeOf<T>::value)
+        throw std::invalid_argument(std::string("streamingAdd: operands must be ") + ElementTraits<T>::name +
+                                    " matrix files");
+    if (left.rows() != right.rows() || left.cols() != right.cols() || left.stride() != right.stride())
+        throw std::invalid_argument("streamingAdd: operand shapes differ");
+
+    const std::size_t rows = left.rows(), cols = left.cols();
+    MatrixFile result = MatrixFile::create<T>(resultPath, rows, cols);
+    left.adviseSequential();
+    right.adviseSequential();
+    if (chunkRows == 0)
+        chunkRows = chunkRowsFor(left);
+    chunkRows = std::min(chunkRows, std::max<std::size_t>(rows, 1));
+
+    struct Slot
+    {
+        Matrix<T> left, right, result;
+    };
+    Slot slots[2] = {{Matrix<T>(chunkRows, cols), Matrix<T>(chunkRows, cols), Matrix<T>(chunkRows, cols)},
+                     {Matrix<T>(chunkRows, cols), Matrix<T>(chunkRows, cols), Matrix<T>(chunkRows, cols)}};
+
+    StreamStats stats;
+    stats.chunks = (rows + chunkRows - 1) / chunkRows;
+    auto chunkSize = [&](std::size_t chunk) { return std::min(chunkRows, rows - chunk * chunkRows); };
+
+    auto readChunk = [&](std::size_t chunk)
+    {
+        Slot &slot = slots[chunk % 2];
+        const std::size_t first = chunk * chunkRows, count = chunkSize(chunk);
+        stats.readNs += timeNanos([&]
+                                  {
+                                      left.readRows(first, count, slot.left);
+                                      right.readRows(first, count, slot.right);
+                                  });
+        left.dropRows(first, count);
+        right.dropRows(first, count);
+        stats.bytesRead += 2.0 * count * left.rowBytes();
+    };
+    // The chunk is on disk, not just in the page cache, before the write counts
+    // as done; it is then dropped so dirty results never pile up in memory.
+    auto writeChunk = [&](std::size_t chunk)
+    {
+        const std::size_t first = chunk * chunkRows, count = chunkSize(chunk);
+        stats.writeNs += timeNanos([&]
+                                   {
+                                       result.writeRows(first, count, slots[chunk % 2].result);
+                                       result.syncRows(first, count);
+                                       result.dropRows(first, count);
+                                   });
+        stats.bytesWritten += 1.0 * count * result.rowBytes();
+    };
+
+    std::vector<Padded<AccumulatorOf<T>>> sums(pool.size());
+    stats.wallNs = timeNanos([&]
+    {
+        if (stats.chunks > 0)
+            readChunk(0);
+        for (std::size_t chunk = 0; chunk < stats.chunks; chunk++)
+        {
+            // The I/O thread only touches the other slot, and only stats fields
+            // the main thread leaves alone until get() joins it.
+            std::future<void> io = std::async(std::launch::async, [&, chunk]
+                                              {
+                                                  if (chunk > 0)
+                                                      writeChunk(chunk - 1);
+                                                  if (chunk + 1 < stats.chunks)
+                                                      readChunk(chunk + 1);
+                                              });
+
+            Slot &slot = slots[chunk % 2];
+            const int count = static_cast<int>(chunkSize(chunk));
+            const std::vector<Tile> tiles = makeTiles(count, static_cast<int>(cols),
+                                                      defaultTileShape(static_cast<int>(cols), sizeof(T)));
+            stats.computeNs += timeNanos([&]
+            {
+                runTiles(pool, tiles, schedule, [&](int worker, const Tile &tile)
+                         { sums[worker].value += matrixAddTile(slot.left, slot.right, slot.result, tile, kernel); });
+            });
+            io.get();
+        }
+        if (stats.chunks > 0)
+            writeChunk(stats.chunks - 1);
+    });
+
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &sum : sums)
+        total += sum.value;
+    stats.sum = static_cast<double>(total);
+    return stats;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#else
+#define CPU_RELAX() std::this_thread::yield()
+#endif
+
+// How idle workers wait for the next dispatch.
+//   Park - block on a condition variable right away (no CPU burned while idle).
+//   Spin - busy-wait for up to `spinLimit` polls before parking, trading CPU for
+//          wake-up latency between back-to-back dispatches. Spinners yield every
+//          SPIN_YIELD_INTERVAL polls so an oversubscribed host still makes progress.
+constexpr int SPIN_YIELD_INTERVAL = 256;
+
+enum class WakePolicy
+{
+    Park,
+    Spin
+};
+
+// Fixed set of worker threads that is created once and reused for every
+// dispatch. The calling thread acts as worker 0, so a pool of size N owns
+// N - 1 std::threads.
+class ThreadPool
+{
+public:
+    using Task = std::function<void(int worker)>;
+    using RangeTask = std::function<void(int worker, int begin, int end)>;
+
+    explicit ThreadPool(int numThreads, WakePolicy policy = WakePolicy::Park, int spinLimit = 1 << 14)
+        : size_(numThreads > 0 ? numThreads : 1), policy_(policy), spinLimit_(spinLimit)
+    {
+        for (int i = 1; i < size_; i++)
+            workers_.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            generation_.fetch_add(1, std::memory_order_release);
+        }
+        wake_.notify_all();
+        for (std::thread &t : workers_)
+            t.join();
+        for (const std::function<void()> &fn : onDestroy_)
+            fn();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const { return size_; }
+    WakePolicy policy() const { return policy_; }
+
+    // Runs `fn` on the destroying thread once the workers have exited, to undo
+    // state the pool applied to its creator (such as worker 0's CPU pinning).
+    void onDestroy(std::function<void()> fn) { onDestroy_.push_back(std::move(fn)); }
+
+    // Runs task(worker) once on every worker in [0, size()) and returns when all are done.
+    void run(const Task &task)
+    {
+        task_ = &task;
+        pending_.store(size_ - 1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            generation_.fetch_add(1, std::memory_order_release);
+        }
+        if (policy_ == WakePolicy::Park || parked_.load(std::memory_order_acquire) > 0)
+            wake_.notify_all();
+
+        task(0);
+
+        for (int spins = 0; pending_.load(std::memory_order_acquire) != 0; spins++)
+        {
+            if (spins < spinLimit_ && spins % SPIN_YIELD_INTERVAL != SPIN_YIELD_INTERVAL - 1)
+                CPU_RELAX();
+            else
+                std::this_thread::yield();
+        }
+        task_ = nullptr;
+    }
+
+    // Splits [begin, end) into size() contiguous ranges of near-equal length.
+    void parallelFor(int begin, int end, const RangeTask &task)
+    {
+        const int count = end - begin;
+        run([&](int worker)
+            {
+                int first = begin + static_cast<int>(static_cast<long long>(count) * worker / size_);
+                int last  = begin + static_cast<int>(static_cast<long long>(count) * (worker + 1) / size_);
+                if (first < last)
+                    task(worker, first, last);
+            });
+    }
+
+private:
+    void workerLoop(int worker)
+    {
+        std::uint64_t seen = 0;
+        for (;;)
+        {
+            std::uint64_t current = generation_.load(std::memory_order_acquire);
+            if (current == seen && policy_ == WakePolicy::Spin)
+            {
+                for (int spins = 0; spins < spinLimit_ && current == seen; spins++)
+                {
+                    if (spins % SPIN_YIELD_INTERVAL == SPIN_YIELD_INTERVAL - 1)
+                        std::this_thread::yield();
+                    else
+                        CPU_RELAX();
+                    current = generation_.load(std::memory_order_acquire);
+                }
+            }
+            if (current == seen)
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                parked_.fetch_add(1, std::memory_order_release);
+                wake_.wait(lock, [&] { return generation_.load(std::memory_order_acquire) != seen; });
+                parked_.fetch_sub(1, std::memory_order_relaxed);
+                current = generation_.load(std::memory_order_acquire);
+            }
+
+            seen = current;
+            if (stop_)
+                return;
+            (*task_)(worker);
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    const int size_;
+    const WakePolicy policy_;
+    const int spinLimit_;
+    std::vector<std::thread> workers_;
+    std::vector<std::function<void()>> onDestroy_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<std::uint64_t> generation_{0};
+    std::atomic<int> pending_{0};
+    std::atomic<int> parked_{0};
+    const Task *task_ = nullptr;
+    bool stop_ = false;
+};
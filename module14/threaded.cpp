@@ -1,47 +1,76 @@
 #include <iostream>
-#include <chrono>
-#include <cstdlib>
-#include <thread>
+#include <iomanip>
+#include "bench.h"
 #include "matrix_add.h"
+#include "numa.h"
+#include "options.h"
+#include "perf_counters.h"
+#include "rng.h"
 
-static double left[NUM_ROWS][NUM_COLS];
-static double right[NUM_ROWS][NUM_COLS];
-static double result[NUM_ROWS][NUM_COLS];
-
-int main()
+template <typename T>
+void run(const Options &options)
 {
-    for (int r = 0; r < NUM_ROWS; r++)
-        for (int c = 0; c < NUM_COLS; c++)
-        {
-            left[r][c]  = rand() % 100;
-            right[r][c] = rand() % 100;
-        }
+    Matrix<T> left(options.rows, options.cols, 0, options.pages);
+    Matrix<T> right(options.rows, options.cols, 0, options.pages);
+    Matrix<T> result(options.rows, options.cols, 0, options.pages);
 
-    const int rowsPerThread = NUM_ROWS / NUM_THREADS;
-    std::thread threads[NUM_THREADS];
-    double sums[NUM_THREADS] = {};
+    // Workers are started once, outside the timed region.
+    const int numThreads = options.threads < options.rows ? options.threads : options.rows;
+    ThreadPool pool(numThreads, options.wake);
+    const std::string pin = applyPinning(pool, options);
 
-    auto start = std::chrono::high_resolution_clock::now();
+    // Each worker touches the pages it will later add. The data depends only on
+    // the seed, so any thread count produces the same matrices and sum.
+    fillRandom(pool, left, LEFT_STREAM, options.seed);
+    fillRandom(pool, right, RIGHT_STREAM, options.seed);
+    parallelFill(pool, result, [](int, int, int) { return T(0); });
 
-    for (int i = 0; i < NUM_THREADS; i++)
+    if (options.numaReport)
     {
-        int startRow = i * rowsPerThread;
-        int endRow   = (i == NUM_THREADS - 1) ? NUM_ROWS - 1 : startRow + rowsPerThread - 1;
-        threads[i] = std::thread(matrixAdd, left, right, result, startRow, endRow, std::ref(sums[i]));
+        printNumaPlacement(std::cout, "left  ", left.data(), left.bytes());
+        printNumaPlacement(std::cout, "right ", right.data(), right.bytes());
+        printNumaPlacement(std::cout, "result", result.data(), result.bytes());
     }
 
-    for (int i = 0; i < NUM_THREADS; i++)
-        threads[i].join();
-
-    auto end = std::chrono::high_resolution_clock::now();
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    // Streaming stores only once the three operands outgrow the last-level cache.
+    const AddKernelOf<T> kernel = addKernelFor<T>(3 * result.bytes(), options.stores);
+    AccumulatorOf<T> total = 0;
+    // Counters bracket every call (warm-ups included); with --counters the
+    // timings include the enable/read overhead.
+    PoolCounters counters(pool, options.counters);
+    TimingStats stats = measure(options.warmups, options.reps,
+                                [&]
+                                {
+                                    counters.start();
+                                    total = matrixAdd(pool, left, right, result, options.schedule,
+                                                      options.reduction, kernel);
+                                    counters.stop();
+                                });
 
-    double total = 0;
-    for (int i = 0; i < NUM_THREADS; i++)
-        total += sums[i];
+    std::cout << "Matrix:       " << options.rows << " x " << options.cols << " " << ElementTraits<T>::name << "\n";
+    std::cout << "Threads:      " << numThreads << " (" << scheduleName(options.schedule) << ", "
+              << reductionName(options.reduction) << " sum, pin " << pin;
+    if (pin != pinPolicyName(PinPolicy::None))
+        for (int cpu : pinAssignment(options.pin, numThreads, options.cpuList))
+            std::cout << " " << cpu;
+    std::cout << ")\n";
+    std::cout << "Stores:       " << (kernel == activeAddKernel<T>() ? "normal" : "streaming") << " ("
+              << storeModeName(options.stores) << ")\n";
+    std::cout << "Pages:        " << describeBacking(left.backing(), left.data(), left.bytes()) << "\n";
+    std::cout << "Sum:          " << std::setprecision(17) << total << "\n";
+    printElapsed(std::cout, stats, 3.0 * sizeof(T) * options.rows * options.cols);
+    if (options.counters)
+        printCounters(std::cout, counters);
+}
 
-    std::cout << "Sum:          " << total << "\n";
-    std::cout << "Elapsed time: " << ms << " ms\n";
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options,
+                      OPT_SHAPE | OPT_POOL_BENCH | OPT_SCHEDULE | OPT_REDUCTION | OPT_STORES | OPT_TYPE | OPT_PAGES |
+                      OPT_NUMA_REPORT | OPT_COUNTERS))
+        return 1;
 
+    withElementType(options.elementType, [&](auto element) { run<decltype(element)>(options); });
     return 0;
 }
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+// Summary of repeated wall-clock samples, in nanoseconds.
+struct TimingStats
+{
+    int samples = 0;
+    double minNs = 0;
+    double medianNs = 0;
+    double p99Ns = 0;
+    double meanNs = 0;
+    double stddevNs = 0;
+};
+
+// Wall-clock nanoseconds of a single call to `body`.
+template <typename Body>
+double timeNanos(Body &&body)
+{
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// Runs `body` `warmups` times untimed, then `reps` times timed, and returns the
+// individual durations in nanoseconds.
+template <typename Body>
+std::vector<double> sampleNanos(int warmups, int reps, Body body)
+{
+    for (int i = 0; i < warmups; i++)
+        body();
+    std::vector<double> times;
+    times.reserve(reps);
+    for (int rep = 0; rep < reps; rep++)
+        times.push_back(timeNanos(body));
+    return times;
+}
+
+// Min, median, nearest-rank 99th percentile, mean and sample standard deviation.
+inline TimingStats summarize(std::vector<double> times)
+{
+    TimingStats stats;
+    stats.samples = static_cast<int>(times.size());
+    if (times.empty())
+        return stats;
+
+    std::sort(times.begin(), times.end());
+    const std::size_t n = times.size();
+    stats.minNs = times.front();
+    stats.medianNs = n % 2 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+    stats.p99Ns = times[static_cast<std::size_t>(std::ceil(0.99 * n)) - 1];
+
+    double total = 0;
+    for (double t : times)
+        total += t;
+    stats.meanNs = total / n;
+
+    double squares = 0;
+    for (double t : times)
+        squares += (t - stats.meanNs) * (t - stats.meanNs);
+    stats.stddevNs = n > 1 ? std::sqrt(squares / (n - 1)) : 0;
+    return stats;
+}
+
+template <typename Body>
+TimingStats measure(int warmups, int reps, Body body)
+{
+    return summarize(sampleNanos(warmups, reps, body));
+}
+
+// Median wall time in microseconds of `reps` calls to `body`, after one warm-up call.
+template <typename Body>
+double medianMicros(int reps, Body body)
+{
+    return measure(1, reps, body).medianNs / 1e3;
+}
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "thread_pool.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// How pool workers are placed on CPUs.
+//   None    - threads float, the scheduler may migrate them at will.
+//   Compact - fill every SMT sibling of a core, then the next core, then the
+//             next package: workers share caches as much as possible.
+//   Scatter - one worker per core alternating packages, SMT siblings only
+//             once every core has one: maximum aggregate cache and bandwidth.
+//   Cores   - first SMT thread of each physical core only, in package order.
+//   List    - the explicit --cpus list, worker i on entry i.
+// Policies wrap around when there are more workers than CPUs.
+enum class PinPolicy
+{
+    None,
+    Compact,
+    Scatter,
+    Cores,
+    List
+};
+
+constexpr PinPolicy ALL_PIN_POLICIES[] = {PinPolicy::None, PinPolicy::Compact, PinPolicy::Scatter, PinPolicy::Cores,
+                                          PinPolicy::List};
+
+inline const char *pinPolicyName(PinPolicy policy)
+{
+    switch (policy)
+    {
+    case PinPolicy::None:    return "none";
+    case PinPolicy::Compact: return "compact";
+    case PinPolicy::Scatter: return "scatter";
+    case PinPolicy::Cores:   return "cores";
+    case PinPolicy::List:    return "list";
+    }
+    return "unknown";
+}
+
+inline bool parsePinPolicy(const std::string &text, PinPolicy &policy)
+{
+    for (PinPolicy candidate : ALL_PIN_POLICIES)
+        if (text == pinPolicyName(candidate))
+        {
+            policy = candidate;
+            return true;
+        }
+    return false;
+}
+
+// Parses a kernel-style CPU list such as "0-3,8,10-11".
+inline bool parseCpuList(const std::string &text, std::vector<int> &cpus)
+{
+    cpus.clear();
+    std::stringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+        const std::size_t dash = item.find('-');
+        char *end = nullptr;
+        const long first = std::strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (end == item.c_str() || (dash == std::string::npos && *end != '\0' && *end != '\n'))
+            return false;
+        if (dash != std::string::npos)
+        {
+            last = std::strtol(item.c_str() + dash + 1, &end, 10);
+            if (*end != '\0' && *end != '\n')
+                return false;
+        }
+        if (first < 0 || last < first)
+            return false;
+        for (long cpu = first; cpu <= last; cpu++)
+            cpus.push_back(static_cast<int>(cpu));
+    }
+    return !cpus.empty();
+}
+
+// One logical CPU. `sibling` is its position among the SMT threads of its core.
+struct CpuInfo
+{
+    int cpu = 0;
+    int core = 0;
+    int package = 0;
+    int node = 0;
+    int sibling = 0;
+};
+
+// Logical CPUs this process may run on, read from /sys/devices/system/cpu
+// (online list, topology/{core_id,physical_package_id,thread_siblings_list}
+// and the nodeN link) and filtered by the affinity mask, so a container's
+// cpuset is respected. Without sysfs every allowed CPU is its own core.
+class CpuTopology
+{
+public:
+    explicit CpuTopology(const std::string &root = "/sys/devices/system/cpu")
+    {
+        std::vector<int> online;
+        if (!parseCpuList(readLine(root + "/online"), online))
+            for (int cpu = 0; cpu < static_cast<int>(std::thread::hardware_concurrency()); cpu++)
+                online.push_back(cpu);
+
+        for (int cpu : online)
+        {
+            if (!allowed(cpu))
+                continue;
+            const std::string dir = root + "/cpu" + std::to_string(cpu);
+            CpuInfo info;
+            info.cpu = cpu;
+            info.core = readInt(dir + "/topology/core_id", cpu);
+            info.package = readInt(dir + "/topology/physical_package_id", 0);
+            info.node = nodeOf(dir);
+            std::vector<int> siblings;
+            if (parseCpuList(readLine(dir + "/topology/thread_siblings_list"), siblings))
+                info.sibling = static_cast<int>(std::find(siblings.begin(), siblings.end(), cpu) - siblings.begin());
+            cpus_.push_back(info);
+        }
+    }
+
+    // Topology of this machine, read once.
+    static const CpuTopology &system()
+    {
+        static const CpuTopology topology;
+        return topology;
+    }
+
+    const std::vector<CpuInfo> &cpus() const { return cpus_; }
+
+    int cores() const
+    {
+        return static_cast<int>(std::count_if(cpus_.begin(), cpus_.end(), [](const CpuInfo &c) { return c.sibling == 0; }));
+    }
+
+    int packages() const
+    {
+        int count = 0;
+        for (const CpuInfo &c : cpus_)
+            count = std::max(count, c.package + 1);
+        return count;
+    }
+
+    // CPUs in the order `policy` hands them to workers (empty for None and List).
+    std::vector<int> order(PinPolicy policy) const
+    {
+        std::vector<CpuInfo> sorted = cpus_;
+        // Rank of each core within its package, so scatter can alternate packages.
+        std::vector<std::tuple<int, int, int>> coreRank;
+        for (const CpuInfo &c : sorted)
+            coreRank.emplace_back(c.package, c.core, 0);
+        std::sort(coreRank.begin(), coreRank.end());
+        coreRank.erase(std::unique(coreRank.begin(), coreRank.end()), coreRank.end());
+        for (std::size_t i = 1; i < coreRank.size(); i++)
+            if (std::get<0>(coreRank[i]) == std::get<0>(coreRank[i - 1]))
+                std::get<2>(coreRank[i]) = std::get<2>(coreRank[i - 1]) + 1;
+        auto rank = [&](const CpuInfo &c)
+        { return std::get<2>(*std::lower_bound(coreRank.begin(), coreRank.end(), std::make_tuple(c.package, c.core, 0))); };
+
+        switch (policy)
+        {
+        case PinPolicy::Compact:
+            std::sort(sorted.begin(), sorted.end(), [](const CpuInfo &a, const CpuInfo &b)
+                      { return std::tie(a.package, a.core, a.sibling, a.cpu) < std::tie(b.package, b.core, b.sibling, b.cpu); });
+            break;
+        case PinPolicy::Scatter:
+        case PinPolicy::Cores:
+            std::sort(sorted.begin(), sorted.end(), [&](const CpuInfo &a, const CpuInfo &b)
+                      {
+                          const int ra = rank(a), rb = rank(b);
+                          return std::tie(a.sibling, ra, a.package, a.cpu) < std::tie(b.sibling, rb, b.package, b.cpu);
+                      });
+            if (policy == PinPolicy::Cores)
+            {
+                sorted.erase(std::remove_if(sorted.begin(), sorted.end(), [](const CpuInfo &c) { return c.sibling != 0; }),
+                             sorted.end());
+                std::stable_sort(sorted.begin(), sorted.end(),
+                                 [](const CpuInfo &a, const CpuInfo &b) { return a.package < b.package; });
+            }
+            break;
+        case PinPolicy::None:
+        case PinPolicy::List:
+            return {};
+        }
+
+        std::vector<int> cpus;
+        for (const CpuInfo &c : sorted)
+            cpus.push_back(c.cpu);
+        return cpus;
+    }
+
+private:
+    static std::string readLine(const std::string &path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    static int readInt(const std::string &path, int fallback)
+    {
+        const std::string line = readLine(path);
+        return line.empty() ? fallback : std::atoi(line.c_str());
+    }
+
+    static int nodeOf(const std::string &cpuDir)
+    {
+#ifdef __linux__
+        if (DIR *dir = ::opendir(cpuDir.c_str()))
+        {
+            int node = 0;
+            while (dirent *entry = ::readdir(dir))
+                if (std::string(entry->d_name).compare(0, 4, "node") == 0 && entry->d_name[4] >= '0' &&
+                    entry->d_name[4] <= '9')
+                    node = std::atoi(entry->d_name + 4);
+            ::closedir(dir);
+            return node;
+        }
+#endif
+        (void)cpuDir;
+        return 0;
+    }
+
+    static bool allowed(int cpu)
+    {
+#ifdef __linux__
+        static const cpu_set_t mask = []
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (::sched_getaffinity(0, sizeof(set), &set) != 0)
+                for (int i = 0; i < CPU_SETSIZE; i++)
+                    CPU_SET(i, &set);
+            return set;
+        }();
+        return cpu < CPU_SETSIZE && CPU_ISSET(cpu, &mask);
+#else
+        (void)cpu;
+        return true;
+#endif
+    }
+
+    std::vector<CpuInfo> cpus_;
+};
+
+// Restricts the calling thread to `cpu`.
+inline bool pinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// CPU of each worker of a pool of `workers` under `policy` (cpuList for List);
+// empty for None.
+inline std::vector<int> pinAssignment(PinPolicy policy, int workers, const std::vector<int> &cpuList,
+                                      const CpuTopology &topology = CpuTopology::system())
+{
+    const std::vector<int> order = policy == PinPolicy::List ? cpuList : topology.order(policy);
+    std::vector<int> cpus;
+    for (int worker = 0; !order.empty() && worker < workers; worker++)
+        cpus.push_back(order[worker % order.size()]);
+    return cpus;
+}
+
+// Pins every worker of `pool` (the calling thread is worker 0) to its CPU in
+// `cpus`. The caller gets its original affinity back when the pool is
+// destroyed, so pools created later do not inherit a one-CPU mask. Returns
+// false, with every thread back on the caller's original mask, if any worker
+// could not be pinned.
+inline bool pinPool(ThreadPool &pool, const std::vector<int> &cpus)
+{
+#ifdef __linux__
+    if (cpus.size() < static_cast<std::size_t>(pool.size()))
+        return false;
+    const pthread_t caller = ::pthread_self();
+    cpu_set_t original;
+    if (::pthread_getaffinity_np(caller, sizeof(original), &original) != 0)
+        return false;
+
+    std::vector<char> pinned(pool.size(), 0);
+    pool.run([&](int worker) { pinned[worker] = pinCurrentThread(cpus[worker]); });
+    if (std::all_of(pinned.begin(), pinned.end(), [](char ok) { return ok != 0; }))
+    {
+        pool.onDestroy([caller, original] { ::pthread_setaffinity_np(caller, sizeof(original), &original); });
+        return true;
+    }
+    // Every worker was started with the caller's mask, so that undoes them all.
+    pool.run([&](int) { ::pthread_setaffinity_np(::pthread_self(), sizeof(original), &original); });
+    return false;
+#else
+    (void)pool;
+    (void)cpus;
+    return false;
+#endif
+}
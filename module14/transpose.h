@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "matrix.h"
+#include "scheduler.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+// Side length below which the recursive transpose stops halving blocks; a
+// 16 x 16 block of doubles touches 32 source and 32 destination lines.
+constexpr std::size_t TRANSPOSE_LEAF = 16;
+// Side of the square blocks handed to pool workers by transpose().
+constexpr int TRANSPOSE_TILE = 256;
+// Per-worker buffer holding one transposed tile of the right operand in
+// matrixAdd(pool, left, StridedView, ...); sized to stay in L2.
+constexpr std::size_t TRANSPOSE_BUFFER_BYTES = 128 * 1024;
+
+// Walks two same-shaped views together, halving the longer side until both
+// sides are at most TRANSPOSE_LEAF, and calls leaf(a, b) on each pair of
+// blocks. The recursion never needs the cache sizes: at some depth each block
+// pair fits in each cache level, so a transposed walk of one view reuses every
+// line it loads (cache-oblivious).
+template <typename A, typename B, typename Leaf>
+void forBlockPairs(const A &a, const B &b, Leaf leaf)
+{
+    const std::size_t rows = a.rows();
+    const std::size_t cols = a.cols();
+    if (rows <= TRANSPOSE_LEAF && cols <= TRANSPOSE_LEAF)
+    {
+        leaf(a, b);
+        return;
+    }
+    if (rows >= cols)
+    {
+        const std::size_t half = rows / 2;
+        forBlockPairs(a.block(0, 0, half, cols), b.block(0, 0, half, cols), leaf);
+        forBlockPairs(a.block(half, 0, rows - half, cols), b.block(half, 0, rows - half, cols), leaf);
+    }
+    else
+    {
+        const std::size_t half = cols / 2;
+        forBlockPairs(a.block(0, 0, rows, half), b.block(0, 0, rows, half), leaf);
+        forBlockPairs(a.block(0, half, rows, cols - half), b.block(0, half, rows, cols - half), leaf);
+    }
+}
+
+// Copies `from` into the same-shaped `to`; with `to` a transposed view this is
+// a cache-oblivious transpose.
+template <typename T>
+void copyBlocked(StridedView<const T> from, StridedView<T> to)
+{
+    forBlockPairs(from, to, [](const StridedView<const T> &source, const StridedView<T> &target)
+                  {
+                      // Inner loop along the target's contiguous side, so
+                      // stores fill whole lines in order.
+                      const T *in = source.data();
+                      T *out = target.data();
+                      const std::ptrdiff_t inRow = source.rowStride(), inCol = source.colStride();
+                      const std::ptrdiff_t outRow = target.rowStride(), outCol = target.colStride();
+                      const std::ptrdiff_t rows = source.rows(), cols = source.cols();
+                      if (outRow == 1)
+                          for (std::ptrdiff_t c = 0; c < cols; c++)
+                              for (std::ptrdiff_t r = 0; r < rows; r++)
+                                  out[c * outCol + r] = in[r * inRow + c * inCol];
+                      else
+                          for (std::ptrdiff_t r = 0; r < rows; r++)
+                              for (std::ptrdiff_t c = 0; c < cols; c++)
+                                  out[r * outRow + c * outCol] = in[r * inRow + c * inCol];
+                  });
+}
+
+// Exchanges the elements of two same-shaped views.
+template <typename T>
+void swapBlocked(StridedView<T> a, StridedView<T> b)
+{
+    forBlockPairs(a, b, [](const StridedView<T> &first, const StridedView<T> &second)
+                  {
+                      for (std::size_t r = 0; r < first.rows(); r++)
+                          for (std::size_t c = 0; c < first.cols(); c++)
+                              std::swap(first(r, c), second(r, c));
+                  });
+}
+
+// Transposes the square view `block` in place: the two diagonal quadrants
+// recursively, then the off-diagonal quadrants swapped with each other's
+// transpose.
+template <typename T>
+void transposeSquare(StridedView<T> block)
+{
+    const std::size_t n = block.rows();
+    if (n <= TRANSPOSE_LEAF)
+    {
+        for (std::size_t r = 0; r < n; r++)
+            for (std::size_t c = r + 1; c < n; c++)
+                std::swap(block(r, c), block(c, r));
+        return;
+    }
+    const std::size_t half = n / 2;
+    transposeSquare(block.block(0, 0, half, half));
+    transposeSquare(block.block(half, half, n - half, n - half));
+    swapBlocked(block.block(0, half, half, n - half), block.block(half, 0, n - half, half).transposed());
+}
+
+// Reference out = inᵀ, reading `in` row by row and writing `out` a column at a
+// time, so every store lands on a different cache line.
+template <typename T>
+void transposeNaive(const Matrix<T> &in, Matrix<T> &out)
+{
+    for (std::size_t r = 0; r < in.rows(); r++)
+        for (std::size_t c = 0; c < in.cols(); c++)
+            out(c, r) = in(r, c);
+}
+
+// out = inᵀ on `pool`: `in` is cut into TRANSPOSE_TILE blocks handed out by
+// `schedule`, and each block is transposed recursively. `out` must be
+// in.cols() x in.rows().
+template <typename T>
+void transpose(ThreadPool &pool, const Matrix<T> &in, Matrix<T> &out, Schedule schedule = Schedule::WorkStealing)
+{
+    if (out.rows() != in.cols() || out.cols() != in.rows())
+        throw std::invalid_argument("transpose output must be in.cols() x in.rows()");
+    const StridedView<const T> source = in.view();
+    const StridedView<T> target = out.transposed();
+    std::vector<Tile> tiles = makeTiles(static_cast<int>(in.rows()), static_cast<int>(in.cols()),
+                                        TileShape{TRANSPOSE_TILE, TRANSPOSE_TILE});
+    runTiles(pool, tiles, schedule, [&](int, const Tile &tile)
+             {
+                 copyBlocked(source.block(tile.row, tile.col, tile.rows, tile.cols),
+                             target.block(tile.row, tile.col, tile.rows, tile.cols));
+             });
+}
+
+// Transposes the square `matrix` in place on `pool`. Each task owns one block
+// on or above the diagonal: diagonal blocks are transposed in place, and the
+// others are swapped with the transpose of their mirror block, so no two tasks
+// touch the same element.
+template <typename T>
+void transposeInPlace(ThreadPool &pool, Matrix<T> &matrix, Schedule schedule = Schedule::WorkStealing)
+{
+    if (matrix.rows() != matrix.cols())
+        throw std::invalid_argument("In-place transpose needs a square matrix");
+    const int n = static_cast<int>(matrix.rows());
+    const StridedView<T> view = matrix.view();
+    std::vector<Tile> tiles;
+    for (const Tile &tile : makeTiles(n, n, TileShape{TRANSPOSE_TILE, TRANSPOSE_TILE}))
+        if (tile.col >= tile.row)
+            tiles.push_back(tile);
+    runTiles(pool, tiles, schedule, [&](int, const Tile &tile)
+             {
+                 if (tile.row == tile.col)
+                     transposeSquare(view.block(tile.row, tile.col, tile.rows, tile.cols));
+                 else
+                     swapBlocked(view.block(tile.row, tile.col, tile.rows, tile.cols),
+                                 view.block(tile.col, tile.row, tile.cols, tile.rows).transposed());
+             });
+}
+
+// Side of the square result tiles for matrixAdd with a strided right operand:
+// the largest power of two whose block of T fits TRANSPOSE_BUFFER_BYTES.
+template <typename T>
+int stridedAddTileSide()
+{
+    int side = 1;
+    while (static_cast<std::size_t>(4 * side * side) * sizeof(T) <= TRANSPOSE_BUFFER_BYTES)
+        side *= 2;
+    return side;
+}
+
+// The calling thread's gather buffer for matrixAdd with a strided right
+// operand, grown to at least rows x cols. It lives as long as the thread, so
+// repeated adds on a pool allocate (and fault in) nothing after the first.
+template <typename T>
+Matrix<T> &stridedAddBuffer(int rows, int cols)
+{
+    thread_local Matrix<T> buffer;
+    if (buffer.rows() < static_cast<std::size_t>(rows) || buffer.cols() < static_cast<std::size_t>(cols))
+        buffer = Matrix<T>(std::max<std::size_t>(buffer.rows(), rows), std::max<std::size_t>(buffer.cols(), cols));
+    return buffer;
+}
+
+// resultMatrix = leftMatrix + right, where `right` is any rows x cols view
+// (e.g. another matrix's transposed()), in one blocked pass, returning the
+// sum. A row-contiguous `right` is fed to `kernel` directly. Otherwise each
+// result tile first gathers its block of `right` into a per-thread L2 buffer
+// with copyBlocked, then runs `kernel` row by row against the buffer, so the
+// vector add kernels are reused and no full-size temporary goes to memory.
+template <typename T>
+AccumulatorOf<T> matrixAdd(ThreadPool &pool,
+                           const Matrix<T> &leftMatrix,
+                           StridedView<const T> right,
+                           Matrix<T> &resultMatrix,
+                           Schedule schedule = Schedule::WorkStealing,
+                           AddKernelOf<T> kernel = activeAddKernel<T>())
+{
+    if (leftMatrix.rows() != resultMatrix.rows() || leftMatrix.cols() != resultMatrix.cols() ||
+        right.rows() != resultMatrix.rows() || right.cols() != resultMatrix.cols())
+        throw std::invalid_argument("matrixAdd operands must have the same shape");
+
+    const int rows = static_cast<int>(resultMatrix.rows());
+    const int cols = static_cast<int>(resultMatrix.cols());
+    std::vector<Padded<AccumulatorOf<T>>> sums(pool.size());
+    if (right.rowContiguous())
+    {
+        std::vector<Tile> tiles = makeTiles(rows, cols, defaultTileShape(cols, sizeof(T)));
+        runTiles(pool, tiles, schedule, [&](int worker, const Tile &tile)
+                 {
+                     for (int row = tile.row; row < tile.row + tile.rows; row++)
+                         sums[worker].value += kernel(leftMatrix.row(row).data() + tile.col, &right(row, tile.col),
+                                                      resultMatrix.row(row).data() + tile.col, tile.cols);
+                 });
+    }
+    else
+    {
+        const int side = stridedAddTileSide<T>();
+        std::vector<Tile> tiles = makeTiles(rows, cols, TileShape{side, side});
+        runTiles(pool, tiles, schedule, [&](int worker, const Tile &tile)
+                 {
+                     Matrix<T> &buffer = stridedAddBuffer<T>(std::min(side, rows), std::min(side, cols));
+                     copyBlocked(right.block(tile.row, tile.col, tile.rows, tile.cols),
+                                 buffer.view().block(0, 0, tile.rows, tile.cols));
+                     for (int r = 0; r < tile.rows; r++)
+                         sums[worker].value += kernel(leftMatrix.row(tile.row + r).data() + tile.col,
+                                                      buffer.row(r).data(),
+                                                      resultMatrix.row(tile.row + r).data() + tile.col, tile.cols);
+                 });
+    }
+
+    AccumulatorOf<T> total = 0;
+    for (const Padded<AccumulatorOf<T>> &sum : sums)
+        total += sum.value;
+    return total;
+}
+
+// resultMatrix = leftMatrix + rightMatrixᵀ without materialising the
+// transpose; rightMatrix must be cols x rows of the result.
+template <typename T>
+AccumulatorOf<T> matrixAddTransposed(ThreadPool &pool,
+                                     const Matrix<T> &leftMatrix,
+                                     const Matrix<T> &rightMatrix,
+                                     Matrix<T> &resultMatrix,
+                                     Schedule schedule = Schedule::WorkStealing,
+                                     AddKernelOf<T> kernel = activeAddKernel<T>())
+{
+    return matrixAdd(pool, leftMatrix, rightMatrix.transposed(), resultMatrix, schedule, kernel);
+}
@@ -1,31 +1,67 @@
 #include <iostream>
-#include <chrono>
-#include <cstdlib>
+#include <iomanip>
+#include "bench.h"
 #include "matrix_add.h"
+#include "numa.h"
+#include "options.h"
+#include "perf_counters.h"
+#include "rng.h"
 
-static double left[NUM_ROWS][NUM_COLS];
-static double right[NUM_ROWS][NUM_COLS];
-static double result[NUM_ROWS][NUM_COLS];
-
-int main()
+template <typename T>
+void run(const Options &options)
 {
-    for (int r = 0; r < NUM_ROWS; r++)
-        for (int c = 0; c < NUM_COLS; c++)
-        {
-            left[r][c]  = rand() % 100;
-            right[r][c] = rand() % 100;
-        }
+    Matrix<T> left(options.rows, options.cols, 0, options.pages);
+    Matrix<T> right(options.rows, options.cols, 0, options.pages);
+    Matrix<T> result(options.rows, options.cols, 0, options.pages);
+
+    // Single worker: the calling thread first-touches every page.
+    ThreadPool pool(1);
+    const std::string pin = applyPinning(pool, options);
 
-    double sum = 0;
-    auto start = std::chrono::high_resolution_clock::now();
+    fillRandom(pool, left, LEFT_STREAM, options.seed);
+    fillRandom(pool, right, RIGHT_STREAM, options.seed);
+    parallelFill(pool, result, [](int, int, int) { return T(0); });
 
-    matrixAdd(left, right, result, 0, NUM_ROWS - 1, sum);
+    if (options.numaReport)
+    {
+        printNumaPlacement(std::cout, "left  ", left.data(), left.bytes());
+        printNumaPlacement(std::cout, "right ", right.data(), right.bytes());
+        printNumaPlacement(std::cout, "result", result.data(), result.bytes());
+    }
 
-    auto end = std::chrono::high_resolution_clock::now();
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    // Streaming stores only once the three operands outgrow the last-level cache.
+    const AddKernelOf<T> kernel = addKernelFor<T>(3 * result.bytes(), options.stores);
+    AccumulatorOf<T> sum = 0;
+    // Counters bracket every call (warm-ups included); with --counters the
+    // timings include the enable/read overhead.
+    PoolCounters counters(pool, options.counters);
+    TimingStats stats = measure(options.warmups, options.reps,
+                                [&]
+                                {
+                                    counters.start();
+                                    matrixAdd(left, right, result, 0, options.rows - 1, sum, kernel);
+                                    counters.stop();
+                                });
 
-    std::cout << "Sum:          " << sum << "\n";
-    std::cout << "Elapsed time: " << ms << " ms\n";
+    std::cout << "Matrix:       " << options.rows << " x " << options.cols << " " << ElementTraits<T>::name << "\n";
+    std::cout << "Pinning:      " << pin << "\n";
+    std::cout << "Stores:       " << (kernel == activeAddKernel<T>() ? "normal" : "streaming") << " ("
+              << storeModeName(options.stores) << ")\n";
+    std::cout << "Pages:        " << describeBacking(left.backing(), left.data(), left.bytes()) << "\n";
+    std::cout << "Sum:          " << std::setprecision(17) << sum << "\n";
+    printElapsed(std::cout, stats, 3.0 * sizeof(T) * options.rows * options.cols);
+    if (options.counters)
+        printCounters(std::cout, counters);
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options,
+                      OPT_SHAPE | OPT_REPS | OPT_WARMUPS | OPT_SEED | OPT_STORES | OPT_TYPE | OPT_PIN | OPT_PAGES |
+                      OPT_NUMA_REPORT | OPT_COUNTERS))
+        return 1;
 
+    withElementType(options.elementType, [&](auto element) { run<decltype(element)>(options); });
     return 0;
 }